@@ -29,6 +29,9 @@
 #include "Timer0.h"
 #include "tm4c123gh6pm.h"
 #include "debug.h"
+#include "udma.h"
+#include "stats.h"
+#include "os.h"
 
 void DisableInterrupts(void); // Disable interrupts
 void EnableInterrupts(void);  // Enable interrupts
@@ -75,7 +78,34 @@ volatile uint32_t ADCsamples=0; // adc sample counter
 uint32_t ADCsamplesMax;       // max number of adc samples to acquire
 uint16_t *ADCBufferPointer;     // global pointer for interrupt usage
 volatile uint32_t ADCvalue;     // adc data
-volatile int ADCstatus=0;  // adc job status
+volatile int ADCstatus=ADC_STATUS_IDLE;  // adc job status
+
+// continuous streaming state, blocks alternate between the primary and alternate uDMA structures
+static uint16_t ADCstreamBuffer[2][ADC_STREAM_BLOCK];
+static ADC_BlockHandler ADCstreamHandler;
+static uint32_t ADCstreamControl;          // uDMA control word of both halves
+static volatile bool ADCstreaming = false;
+static unsigned int ADCstreamChannels;      // samples of one channel feed the statistics
+
+// capture header, and where stream block times count from (moved on after a gap)
+ADC_BlockHeader ADCheader;
+static uint32_t ADCstreamBaseBlock;
+static uint32_t ADCstreamBaseCycles;
+static uint32_t ADCstreamBaseMs;
+static uint8_t ADCstreamFlags;             // flags for the next block
+
+// averaging, hardware oversampling applies to every conversion, decimation to ADC_Collect
+// length of the list sequencers 0 and 1 convert, and the handler that gets every result of it
+static unsigned int ADCsequenceLength;
+static ADC_SequenceHandler ADCsequenceHandler = NULL;
+
+static unsigned int ADChwAverage = 0;      // log2 of conversions averaged by ADC0_SAC_R
+static unsigned int ADCdecimation = 0;     // log2 of conversions summed per stored sample
+static uint32_t ADCaccumulator;
+static uint32_t ADCaccumulated;
+static bool ADCstreamNext;                 // half that completes next, true for the alternate
+volatile uint32_t ADCstreamBlocks;         // blocks handed to the handler
+volatile uint32_t ADCstreamOverruns;       // times both halves filled before we got to them
 //------------------------------------------------------------------------
 // config gpio mux
 int ADC_Pin_Config(unsigned int channelNum){
@@ -192,6 +222,7 @@ void ADC_Init(unsigned int channelNum){
 	SYSCTL_RCGCADC_R |= 0x01;        // activate ADC0 
 	while((SYSCTL_PRADC_R&SYSCTL_PRADC_R0)==0){} // allow time to finish activating
 	ADC0_PC_R = ADC_PP_MSR_1M;       // configure for 1M samples/sec                      0x07 for 1MSps
+  ADC0_SAC_R = ADChwAverage;       // hardware oversampling
   ADC0_SSPRI_R = 0x3210;    // sequencer 0 is highest, sequencer 3 is lowest
   ADC0_ACTSS_R &= ~0x08;    // disable sample sequencer 3
   ADC0_EMUX_R = (ADC0_EMUX_R&0xFFFF0FFF)+0x5000; // timer trigger event
@@ -205,28 +236,269 @@ void ADC_Init(unsigned int channelNum){
 }
 
 
+// config ADC for a list of up to 12 channels, the first 8 on sequencer 0 and the rest on
+// sequencer 1, every Timer0A trigger converts the whole list (repeats allowed) and interrupts
+// once at the end (sequencer 1 runs after sequencer 0, so its interrupt covers both)
+void ADC_InitMulti(const uint8_t channels[], unsigned int numChannels){
+  unsigned int steps0 = (numChannels > ADC_SS0_DEPTH) ? ADC_SS0_DEPTH : numChannels;
+  unsigned int steps1 = numChannels - steps0;
+  uint32_t mux0 = 0;
+  uint32_t mux1 = 0;
+  for (unsigned int i = 0; i < steps0; i++){
+    mux0 |= (uint32_t)channels[i] << (4*i);   // one nibble per step
+  }
+  for (unsigned int i = 0; i < steps1; i++){
+    mux1 |= (uint32_t)channels[steps0 + i] << (4*i);
+  }
+  ADCsequenceLength = numChannels;
+  DisableInterrupts();             // disable interrupt
+	SYSCTL_RCGCADC_R |= 0x01;        // activate ADC0 
+	while((SYSCTL_PRADC_R&SYSCTL_PRADC_R0)==0){} // allow time to finish activating
+	ADC0_PC_R = ADC_PP_MSR_1M;       // configure for 1M samples/sec
+  ADC0_SAC_R = ADChwAverage;       // hardware oversampling
+  ADC0_SSPRI_R = 0x3210;           // sequencer 0 is highest, sequencer 3 is lowest
+  ADC0_ACTSS_R &= ~0x0B;           // disable sample sequencers 0, 1 and 3
+  ADC0_EMUX_R = (ADC0_EMUX_R&0xFFFFFF00)+0x0055; // timer trigger event on both
+  ADC0_SSMUX0_R = mux0;
+  ADC0_SSMUX1_R = mux1;
+  if (steps1 == 0){
+    ADC0_SSCTL0_R = (ADC_SSCTL0_IE0|ADC_SSCTL0_END0) << (4*(steps0-1)); // flag and end on the last step
+  } else {
+    ADC0_SSCTL0_R = ADC_SSCTL0_END0 << (4*(steps0-1));
+    ADC0_SSCTL1_R = (ADC_SSCTL1_IE0|ADC_SSCTL1_END0) << (4*(steps1-1));
+  }
+  while ((ADC0_SSFSTAT0_R & ADC_SSFSTAT0_EMPTY) == 0){
+    (void)ADC0_SSFIFO0_R;          // drop leftovers from an aborted capture
+  }
+  while ((ADC0_SSFSTAT1_R & ADC_SSFSTAT1_EMPTY) == 0){
+    (void)ADC0_SSFIFO1_R;
+  }
+  ADC0_OSTAT_R = ADC_OSTAT_OV0|ADC_OSTAT_OV1;
+  ADC0_ISC_R = 0x03;
+  ADC0_IM_R = (ADC0_IM_R&~0x03)|((steps1 == 0) ? 0x01 : 0x02); // interrupt from the last sequencer
+  ADC0_ACTSS_R |= (steps1 == 0) ? 0x01 : 0x03;
+  NVIC_PRI3_R = (NVIC_PRI3_R&0x0000FFFF)|0x40400000; //priority 2
+  NVIC_EN0_R = (1<<14)|(1<<15);    // enable interrupts 14 and 15 in NVIC
+}
+
+// fills the capture header right after Timer0 starts, its first trigger is one period away
+static void ADC_StampStart(unsigned int channel, unsigned int channels, unsigned int fs, uint32_t periodCycles,
+                           uint32_t sampleCycles, unsigned int bits, uint32_t samples){
+  uint32_t cycles = OS_ReadCycles();
+  ADCheader.sequence = 0;
+  ADCheader.startCycles = cycles + periodCycles;
+  ADCheader.startMs = OS_ReadPeriodicTime() + periodCycles/(ADC_BUS_HZ/1000);
+  ADCheader.periodCycles = periodCycles;
+  ADCheader.sampleCycles = sampleCycles;
+  ADCheader.rateMilliHz = (uint32_t)((uint64_t)ADC_BUS_HZ*1000/sampleCycles);
+  ADCheader.requestedHz = fs;
+  ADCheader.samples = samples;
+  ADCheader.channel = channel;
+  ADCheader.channels = channels;
+  ADCheader.bits = bits;
+  ADCheader.flags = 0;
+}
+
 int ADC_Collect(unsigned int channelNum, unsigned int fs, unsigned short buffer[], unsigned int numberOfSamples){
 	ADCsamplesMax=numberOfSamples;                 // max # of samples
 	ADCBufferPointer=buffer;                       // save address to global variable
 	ADCsamples=0;                                  // make sure we start at 0
 	ADCstatus=ADC_STATUS_BUSY;                                   // reset job status to not done
+  ADCaccumulator=0;                              // decimation starts on a fresh sum
+  ADCaccumulated=0;
+  STATS_Reset();
 
 	// config gpio mux. clk to gpio. pin function config
 	int status = ADC_Pin_Config(channelNum);
 	// config ADC with interrupt.  Timer-triggered ADC
 	ADC_Init(channelNum);
-	// init timer to trigger adc based on sampling frequency fs
+	// init timer to trigger adc based on sampling frequency fs, times the decimation ratio
 	// given min fs=100 Hz we use prescaler of 12 for the 16-bit timer
 	uint32_t 	TIMER_PRESCALER = 0x0C; // prescaler is 12 so that the max time is 80MHz/100Hz/(12+1)=10.65 ms for fs=100 Hz
-	Timer0_Init(fs,TIMER_PRESCALER);
+  uint32_t rate = fs << ADCdecimation;
+	uint32_t period = Timer0_Init(rate, (rate < 2000) ? TIMER_PRESCALER : 0);
+  ADC_StampStart(channelNum, 1, fs, period, period << ADCdecimation, ADC_SampleBits(), numberOfSamples);
+  EnableInterrupts();
+	return status;
+}
+
+
+int ADC_CollectMulti(const uint8_t channels[], unsigned int numChannels, unsigned int fs, unsigned short buffer[], unsigned int numberOfSamples){
+  int status = 0;
+  if (numChannels < 1 || numChannels > ADC_SCAN_MAX){
+    return 1;
+  }
+  ADCsequenceHandler = NULL;
+	ADCsamplesMax=numberOfSamples;                 // max # of samples
+	ADCBufferPointer=buffer;                       // save address to global variable
+	ADCsamples=0;                                  // make sure we start at 0
+	ADCstatus=ADC_STATUS_BUSY;                     // reset job status to not done
+
+	// config gpio mux for every channel in the list, then SS0 with one interrupt per trigger
+  for (unsigned int i = 0; i < numChannels; i++){
+    status |= ADC_Pin_Config(channels[i]);
+  }
+  ADC_InitMulti(channels, numChannels);
+	uint32_t period = Timer0_Init(fs, (fs < 2000) ? 0x0C : 0); // same prescaler as ADC_Collect
+  ADC_StampStart(channels[0], numChannels, fs, period, period, 12, numberOfSamples);
   EnableInterrupts();
 	return status;
 }
 
+// config ADC0 and ADC1 sequencer 3 for one channel each, both on the Timer0A trigger, ADC1
+// delayed by phase/16 of a conversion and interrupting once both results are in
+void ADC_InitDual(unsigned int channel0, unsigned int channel1, unsigned int phase){
+  ADC_Init(channel0);              // ADC0 as for ADC_Collect, leaves interrupts disabled
+  ADC0_IM_R &= ~0x08;              // ADC1's interrupt reads both
+  NVIC_DIS0_R = 1<<17;
+  
+	SYSCTL_RCGCADC_R |= 0x02;        // activate ADC1
+	while((SYSCTL_PRADC_R&SYSCTL_PRADC_R1)==0){} // allow time to finish activating
+	ADC1_PC_R = ADC_PP_MSR_1M;       // configure for 1M samples/sec
+  ADC1_SAC_R = ADChwAverage;       // same hardware oversampling as ADC0
+  ADC1_SPC_R = phase;              // sample phase delay
+  ADC1_SSPRI_R = 0x3210;
+  ADC1_ACTSS_R &= ~0x08;           // disable sample sequencer 3
+  ADC1_EMUX_R = (ADC1_EMUX_R&0xFFFF0FFF)+0x5000; // timer trigger event
+  ADC1_SSMUX3_R = channel1;
+  ADC1_SSCTL3_R = 0x06;            // set flag and end
+  ADC1_ISC_R = 0x08;
+  ADC1_IM_R |= 0x08;               // enable SS3 interrupts
+  ADC1_ACTSS_R |= 0x08;            // enable sample sequencer 3
+  NVIC_PRI12_R = (NVIC_PRI12_R&0x00FFFFFF)|0x40000000; //priority 2
+  NVIC_EN1_R = 1<<(51-32);         // enable interrupt 51 in NVIC
+}
+
+int ADC_CollectDual(unsigned int channel0, unsigned int channel1, unsigned int phase, unsigned int fs,
+                    unsigned short buffer[], unsigned int numberOfPairs){
+  if (phase > ADC_SPC_PHASE_M){
+    return 1;
+  }
+	ADCsamplesMax=2*numberOfPairs;                 // max # of samples, two per pair
+	ADCBufferPointer=buffer;                       // save address to global variable
+	ADCsamples=0;                                  // make sure we start at 0
+	ADCstatus=ADC_STATUS_BUSY;                     // reset job status to not done
+
+	int status = ADC_Pin_Config(channel0) | ADC_Pin_Config(channel1);
+  ADC_InitDual(channel0, channel1, phase);
+	uint32_t period = Timer0_Init(fs, (fs < 2000) ? 0x0C : 0); // one trigger starts both ADCs
+  ADC_StampStart(channel0, 2, fs, period, period, 12, 2*numberOfPairs);
+  EnableInterrupts();
+	return status;
+}
+
+// averaging for the following captures, see adc.h
+int ADC_SetAveraging(unsigned int hardwareLog2, unsigned int decimationLog2){
+  if (hardwareLog2 > ADC_MAX_HW_AVERAGE || decimationLog2 > ADC_MAX_DECIMATION){
+    return 1;
+  }
+  ADChwAverage = hardwareLog2;
+  ADCdecimation = decimationLog2;
+  return 0;
+}
+
+// bits in every sample ADC_Collect stores
+unsigned int ADC_SampleBits(void){
+  return 12 + ((ADCdecimation > 4) ? 4 : ADCdecimation);
+}
+
+// converts the list on every trigger and hands the results to handler, until ADC_Stop
+int ADC_SequenceStart(const uint8_t channels[], unsigned int numChannels, unsigned int fs, ADC_SequenceHandler handler){
+  int status = 0;
+  if (numChannels < 1 || numChannels > ADC_SCAN_MAX){
+    return 1;
+  }
+  for (unsigned int i = 0; i < numChannels; i++){
+    status |= ADC_Pin_Config(channels[i]);
+  }
+  if (status){
+    return status;
+  }
+  ADCsequenceHandler = handler;
+  ADCstatus = ADC_STATUS_BUSY;
+  ADC_InitMulti(channels, numChannels);
+	uint32_t period = Timer0_Init(fs, (fs < 2000) ? 0x0C : 0);
+  ADC_StampStart(channels[0], numChannels, fs, period, period, 12, 0);  // the handler stores
+  EnableInterrupts();
+  return 0;
+}
 
 // adc job status
 int ADC_Status(){return ADCstatus;}
 
+// streams a list of 1, 2, 4 or 8 channels through uDMA channel 14 into ping-pong blocks
+int ADC_StreamStart(const uint8_t channels[], unsigned int numChannels, unsigned int fs, ADC_BlockHandler handler){
+  int status = 0;
+  uint32_t arbitration = 0;
+  
+  // the uDMA moves one whole sequence per request, so the list length must be a burst size
+  switch (numChannels){
+    case 1: arbitration = UDMA_CHCTL_ARBSIZE_1; break;
+    case 2: arbitration = UDMA_CHCTL_ARBSIZE_2; break;
+    case 4: arbitration = UDMA_CHCTL_ARBSIZE_4; break;
+    case 8: arbitration = UDMA_CHCTL_ARBSIZE_8; break;
+    default: return 1;
+  }
+  for (unsigned int i = 0; i < numChannels; i++){
+    status |= ADC_Pin_Config(channels[i]);
+  }
+  if (status){
+    return status;
+  }
+  
+  ADCstreamHandler = handler;
+  ADCstreamChannels = numChannels;
+  ADCstreamBlocks = 0;
+  ADCstreamOverruns = 0;
+  ADCstreamNext = false;
+  ADCstreamControl = UDMA_CHCTL_DSTINC_16 | UDMA_CHCTL_DSTSIZE_16 | UDMA_CHCTL_SRCINC_NONE |
+                     UDMA_CHCTL_SRCSIZE_16 | arbitration | UDMA_CHCTL_XFERMODE_PINGPONG;
+  ADCstatus = ADC_STATUS_BUSY;
+  STATS_Reset();
+  
+  // arm both halves before the first trigger
+  UDMA_Init();
+  UDMA_AssignChannel(UDMA_CH_ADC0_SS0, 0);
+  UDMA_SetTransfer(UDMA_CH_ADC0_SS0, false, &ADC0_SSFIFO0_R, ADCstreamBuffer[0], ADC_STREAM_BLOCK, ADCstreamControl);
+  UDMA_SetTransfer(UDMA_CH_ADC0_SS0, true, &ADC0_SSFIFO0_R, ADCstreamBuffer[1], ADC_STREAM_BLOCK, ADCstreamControl);
+  UDMA_EnableChannel(UDMA_CH_ADC0_SS0);
+  ADCstreaming = true;
+  
+  ADC_InitMulti(channels, numChannels);
+  
+  // the 16-bit timer needs the prescaler below ~1.3kHz, without it the period is exact to 12.5ns
+	uint32_t period = Timer0_Init(fs, (fs < 2000) ? 0x0C : 0);
+  ADC_StampStart(channels[0], numChannels, fs, period, period, 12, ADC_STREAM_BLOCK);
+  ADCstreamBaseBlock = 0;
+  ADCstreamBaseCycles = ADCheader.startCycles;
+  ADCstreamBaseMs = ADCheader.startMs;
+  ADCstreamFlags = 0;
+  EnableInterrupts();
+  return 0;
+}
+
+// abandons a collection in progress, the samples stored so far stay in the buffer
+void ADC_Stop(void){
+  TIMER0_CTL_R = 0x00000000;       // disable timer0
+  ADC0_ACTSS_R &= ~0x0B;           // disable sample sequencers 0, 1 and 3
+  ADC0_ISC_R = 0x0B;               // drop a conversion that completed meanwhile
+  ADCsequenceHandler = NULL;
+  if (SYSCTL_PRADC_R & SYSCTL_PRADC_R1){
+    ADC1_ACTSS_R &= ~0x08;         // dual capture, ADC1 registers fault while it is unclocked
+    ADC1_ISC_R = 0x08;
+  }
+  if (ADCstreaming){
+    UDMA_DisableChannel(UDMA_CH_ADC0_SS0);
+    ADCstreaming = false;
+  }
+  if (ADCstatus == ADC_STATUS_BUSY){
+    ADCheader.flags |= ADC_FLAG_STOPPED;
+  }
+  ADCsamplesMax = ADCsamples;      // only what was stored is valid
+  ADCheader.samples = ADCsamples;
+  ADCstatus = ADC_STATUS_IDLE;
+}
+
 // current value in timer
 volatile uint32_t Timer0_Current;
 // IRQ 19 handler.  This is for timer0 debugging.  Normally IRQ 19 is disabled
@@ -250,9 +522,22 @@ void ADC0Seq3_Handler(void){
   debug_ledOff(PF2);
 	
 	ADC0_ISC_R = 0x08;               // acknowledge ADC sequence 3 completion
+  if (ADC0_OSTAT_R & ADC_OSTAT_OV3){
+    ADC0_OSTAT_R = ADC_OSTAT_OV3;  // a trigger came before we read the last result
+    ADCheader.flags |= ADC_FLAG_OVERFLOW;
+  }
 	ADCvalue = (ADC0_SSFIFO3_R&0x00000FFF);       // save last 12 bits from 32-bit result
+  
+  // decimation: sum 2^n conversions, keeping at most 16 bits of the sum
+  ADCaccumulator += ADCvalue;
+  if (++ADCaccumulated < (1u << ADCdecimation)){
+    return;
+  }
 		                               // store result inside a 16-bit buffer
-	*(ADCBufferPointer+ADCsamples) = (uint16_t)ADCvalue; 
+	*(ADCBufferPointer+ADCsamples) = (uint16_t)(ADCaccumulator >> ((ADCdecimation > 4) ? ADCdecimation - 4 : 0)); 
+  STATS_Add(*(ADCBufferPointer+ADCsamples));
+  ADCaccumulator = 0;
+  ADCaccumulated = 0;
   ADCsamples++;                    // counter
 
                                    // if reached quota
@@ -261,7 +546,133 @@ void ADC0Seq3_Handler(void){
 		ADC0_ACTSS_R &= ~0x08;         // disable sample sequencer 3
 		//ADCsamples=0;                // reset counter
 		ADCstatus=ADC_STATUS_DONE;		 // set flag to 1 indicating job done
+		LOG_INFO(ADC, "collection done, %d samples", ADCsamples);
 		return;                        // exit function
 	}
 	
 }
+
+// uDMA half of the IRQ 14 handler, hands every finished block to the handler in order and re-arms
+// it, the other half is filling meanwhile so the handler has one block time
+static void ADC_StreamInterrupt(void){
+  UDMA_CHIS_R = 1u << UDMA_CH_ADC0_SS0;  // acknowledge uDMA completion
+  if (ADC0_OSTAT_R & ADC_OSTAT_OV0){
+    ADC0_OSTAT_R = ADC_OSTAT_OV0;
+    ADCstreamFlags |= ADC_FLAG_OVERFLOW;
+  }
+  while (UDMA_TransferDone(UDMA_CH_ADC0_SS0, ADCstreamNext)){
+    uint16_t* block = ADCstreamBuffer[ADCstreamNext];
+    
+    // the block's first trigger, counted in exact timer periods from the last time base
+    ADC_BlockHeader header = ADCheader;
+    uint64_t offset = (uint64_t)(ADCstreamBlocks - ADCstreamBaseBlock) * (ADC_STREAM_BLOCK/ADCstreamChannels) *
+                      ADCheader.periodCycles;
+    header.sequence = ADCstreamBlocks;
+    header.startCycles = ADCstreamBaseCycles + (uint32_t)offset;
+    header.startMs = ADCstreamBaseMs + (uint32_t)(offset/(ADC_BUS_HZ/1000));
+    header.flags = ADCstreamFlags;
+    ADCstreamFlags = 0;
+    
+    if (ADCstreamChannels == 1){
+      STATS_AddBlock(block, ADC_STREAM_BLOCK);   // raw samples, before the handler changes them
+    }
+    ADCstreamHandler(block, ADC_STREAM_BLOCK, &header);
+    if (!ADCstreaming){
+      return;                            // the handler ended the stream
+    }
+    UDMA_SetTransfer(UDMA_CH_ADC0_SS0, ADCstreamNext, &ADC0_SSFIFO0_R, block, ADC_STREAM_BLOCK, ADCstreamControl);
+    ADCstreamBlocks++;
+    ADCstreamNext = !ADCstreamNext;
+  }
+  
+  // with both halves stopped the controller disables the channel, restart from the primary
+  if ((UDMA_ENASET_R & (1u << UDMA_CH_ADC0_SS0)) == 0){
+    ADCstreamOverruns++;
+    ADCstreamNext = false;
+    UDMA_EnableChannel(UDMA_CH_ADC0_SS0);
+    
+    // triggers were missed for an unknown time, the next block starts a new time base at the
+    // next trigger (approximately, it may already be under way)
+    ADCstreamBaseBlock = ADCstreamBlocks;
+    ADCstreamBaseCycles = OS_ReadCycles() + (TIMER0_TAR_R & 0xFFFF) * (TIMER0_TAPR_R + 1);
+    ADCstreamBaseMs = OS_ReadPeriodicTime();
+    ADCstreamFlags |= ADC_FLAG_GAP;
+  }
+}
+
+// one interrupt per trigger drains every step sequencers 0 and 1 converted, in list order
+static void ADC_SequenceInterrupt(void){
+  uint16_t results[ADC_SCAN_MAX];
+  unsigned int count = 0;
+  while ((ADC0_SSFSTAT0_R & ADC_SSFSTAT0_EMPTY) == 0 && count < ADC_SCAN_MAX){
+    results[count++] = (uint16_t)(ADC0_SSFIFO0_R&0x00000FFF);
+  }
+  while ((ADC0_SSFSTAT1_R & ADC_SSFSTAT1_EMPTY) == 0 && count < ADC_SCAN_MAX){
+    results[count++] = (uint16_t)(ADC0_SSFIFO1_R&0x00000FFF);
+  }
+  if (ADC0_OSTAT_R & (ADC_OSTAT_OV0|ADC_OSTAT_OV1)){
+    ADC0_OSTAT_R = ADC_OSTAT_OV0|ADC_OSTAT_OV1;
+    ADCheader.flags |= ADC_FLAG_OVERFLOW;
+  }
+  if (count != ADCsequenceLength){
+    ADCheader.flags |= ADC_FLAG_DROPPED;
+    return;                        // partial sequence (FIFO overflow), drop it to stay in step
+  }
+  if (ADCsequenceHandler != NULL){
+    ADCsequenceHandler(results, count);
+    return;
+  }
+  
+  for (unsigned int i = 0; i < count && ADCsamples < ADCsamplesMax; i++){
+    ADCBufferPointer[ADCsamples++] = results[i];
+  }
+
+                                   // if reached quota
+	if(ADCsamples >= ADCsamplesMax){
+		TIMER0_CTL_R = 0x00000000;     // disable timer0
+		ADC0_ACTSS_R &= ~0x03;         // disable sample sequencers 0 and 1
+		ADCstatus=ADC_STATUS_DONE;
+		LOG_INFO(ADC, "collection done, %d samples", ADCsamples);
+	}
+}
+
+// IRQ 14 handler, streaming blocks or lists of up to 8 channels
+void ADC0Seq0_Handler(void){
+	ADC0_ISC_R = 0x01;               // acknowledge ADC sequence 0 completion
+  if (ADCstreaming){
+    ADC_StreamInterrupt();
+    return;
+  }
+  ADC_SequenceInterrupt();
+}
+
+// IRQ 15 handler, lists of 9 to 12 channels
+void ADC0Seq1_Handler(void){
+	ADC0_ISC_R = 0x02;               // acknowledge ADC sequence 1 completion
+  ADC_SequenceInterrupt();
+}
+
+// IRQ 51 handler, stores the ADC0 and ADC1 results of one trigger as a pair
+void ADC1Seq3_Handler(void){
+	ADC1_ISC_R = 0x08;               // acknowledge ADC1 sequence 3 completion
+  if ((ADC0_OSTAT_R & ADC_OSTAT_OV3) || (ADC1_OSTAT_R & ADC_OSTAT_OV3)){
+    ADC0_OSTAT_R = ADC_OSTAT_OV3;
+    ADC1_OSTAT_R = ADC_OSTAT_OV3;
+    ADCheader.flags |= ADC_FLAG_OVERFLOW;
+  }
+  // ADC0 finishes first unless phase is 0, then it is at most a conversion behind
+  for (int i = 0; i < 100 && (ADC0_SSFSTAT3_R & ADC_SSFSTAT3_EMPTY); i++) {}
+  
+  if (ADCsamples + 2 <= ADCsamplesMax){
+    ADCBufferPointer[ADCsamples++] = (uint16_t)(ADC0_SSFIFO3_R&0x00000FFF);
+    ADCBufferPointer[ADCsamples++] = (uint16_t)(ADC1_SSFIFO3_R&0x00000FFF);
+  }
+  
+	if(ADCsamples >= ADCsamplesMax){
+		TIMER0_CTL_R = 0x00000000;     // disable timer0
+		ADC0_ACTSS_R &= ~0x08;         // disable both sample sequencers
+		ADC1_ACTSS_R &= ~0x08;
+		ADCstatus=ADC_STATUS_DONE;
+		LOG_INFO(ADC, "dual collection done, %d pairs", ADCsamples/2);
+	}
+}
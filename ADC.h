@@ -25,16 +25,64 @@
 #define ADC_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #define ADC_STATUS_BUSY 0
 #define ADC_STATUS_DONE 1
 #define ADC_STATUS_IDLE 2
+
+#define ADC_SS0_DEPTH 8   // steps (and FIFO entries) of sample sequencer 0
+#define ADC_SCAN_MAX  12  // channels in a list, sequencer 0 then sequencer 1 (4 steps)
+
+// called from the ADC interrupt with the results of one trigger, in list order
+typedef void (*ADC_SequenceHandler)(const uint16_t* results, unsigned int count);
+
+#define ADC_MAX_HW_AVERAGE 6   // log2, 64x
+#define ADC_MAX_DECIMATION 8   // log2, 256x
+
+#define ADC_STREAM_BLOCK 512   // samples per streaming block (at most UDMA_MAX_XFER)
+
+// header flags
+#define ADC_FLAG_OVERFLOW 0x01  // a sequencer FIFO overflowed, conversions were lost
+#define ADC_FLAG_GAP      0x02  // stream blocks were lost before this one, its time was re-stamped
+#define ADC_FLAG_DROPPED  0x04  // an incomplete list was dropped to keep the channels in step
+#define ADC_FLAG_STOPPED  0x08  // ADC_Stop ended the capture before it was full
+
+#define ADC_BUS_HZ 80000000     // Timer0 and the cycle counter run on the bus clock
+
+// When and how a capture or stream block was sampled. Times are those of the first trigger,
+// sample n of a channel was triggered startCycles + n*sampleCycles bus cycles later, so blocks
+// line up exactly without relying on the requested rate.
+typedef struct {
+  uint32_t sequence;        // stream block number, 0 for a capture
+  uint32_t startMs;         // OS_ReadPeriodicTime at the first trigger
+  uint32_t startCycles;     // OS_ReadCycles at the first trigger (wraps every 53.7s)
+  uint32_t periodCycles;    // bus cycles between Timer0 triggers, exact
+  uint32_t sampleCycles;    // bus cycles between stored samples of a channel (decimation included)
+  uint32_t rateMilliHz;     // actual stored sample rate of a channel, ADC_BUS_HZ/sampleCycles
+  uint32_t requestedHz;     // rate that was asked for
+  uint32_t samples;         // samples in the capture or block, all channels
+  uint8_t channel;          // first channel of the list
+  uint8_t channels;         // channels interleaved per trigger
+  uint8_t bits;             // bits per sample
+  uint8_t flags;            // ADC_FLAG_*
+} ADC_BlockHeader;
+
+// header of the last capture (the stream's settings while streaming)
+extern ADC_BlockHeader ADCheader;
+
+// called from the ADC interrupt with every full streaming block and its header, it must be
+// done with the block before the next one fills (ADC_STREAM_BLOCK samples later), it may end
+// the stream with ADC_Stop
+typedef void (*ADC_BlockHandler)(uint16_t* block, uint32_t length, const ADC_BlockHeader* header);
  
 extern volatile uint32_t ADCsamples; // adc sample counter
 extern uint32_t ADCsamplesMax;       // max number of adc samples to acquire
 extern uint16_t *ADCBufferPointer;     // global pointer for interrupt usage
 extern volatile uint32_t ADCvalue;     // adc data
 extern volatile int ADCstatus;  // adc job status
+extern volatile uint32_t ADCstreamBlocks;     // streaming blocks delivered
+extern volatile uint32_t ADCstreamOverruns;   // streaming gaps, both blocks filled before we got to them
 
 // This initialization function sets up the ADC according to the
 // following parameters.  Any parameters not explicitly listed
@@ -70,11 +118,65 @@ extern volatile int ADCstatus;  // adc job status
 // 0 success
 int ADC_Collect(unsigned int channelNum, unsigned int fs, unsigned short buffer[], unsigned int numberOfSamples);
 
+// Same as ADC_Collect, but every trigger converts a list of up to ADC_SCAN_MAX channels on
+// sample sequencers 0 and 1 and one interrupt drains them all. The list may repeat a channel to take
+// several samples of it per trigger. Samples are stored interleaved in list order, so
+// numberOfSamples should be a multiple of numChannels.
+// output:
+// 1 error
+// 0 success
+int ADC_CollectMulti(const uint8_t channels[], unsigned int numChannels, unsigned int fs, unsigned short buffer[], unsigned int numberOfSamples);
+
+// Converts a list of up to ADC_SCAN_MAX channels on every Timer0A trigger (fs) and hands each
+// trigger's results to handler, until ADC_Stop. The handler does its own storing.
+// output:
+// 1 error
+// 0 success
+int ADC_SequenceStart(const uint8_t channels[], unsigned int numChannels, unsigned int fs, ADC_SequenceHandler handler);
+
+// Continuous acquisition: sequencer 0 converts the list (1, 2, 4 or 8 channels, repeats allowed)
+// on every Timer0A trigger and uDMA channel 14 moves the results into two ping-pong blocks, so the
+// CPU is interrupted once per ADC_STREAM_BLOCK samples instead of once per sample. fs is the
+// trigger rate, fs * numChannels may go up to the ADC's 1Msps. Runs until ADC_Stop.
+// output:
+// 1 error
+// 0 success
+int ADC_StreamStart(const uint8_t channels[], unsigned int numChannels, unsigned int fs, ADC_BlockHandler handler);
+
+// Simultaneous capture of two channels: ADC0 converts channel0 and ADC1 channel1 on the same
+// Timer0A trigger, ADC1 delayed by phase (0-15) sixteenths of a conversion period (8 interleaves
+// the two halfway). Pairs are stored ADC0 first, so the buffer holds 2*numberOfPairs samples.
+// Decimation does not apply.
+// output:
+// 1 error
+// 0 success
+int ADC_CollectDual(unsigned int channel0, unsigned int channel1, unsigned int phase, unsigned int fs,
+                    unsigned short buffer[], unsigned int numberOfPairs);
+
+// config ADC0 and ADC1 sequencer 3 for a dual capture
+void ADC_InitDual(unsigned int channel0, unsigned int channel1, unsigned int phase);
+
+// Averaging for the following captures.
+// hardwareLog2   0-6, ADC0 averages 2^n conversions into every result (ADC0_SAC_R), all modes.
+//                Each result takes 2^n conversion times, so the top rate drops by that factor.
+// decimationLog2 0-8, ADC_Collect sums 2^n results into every stored sample and triggers
+//                2^n times faster to keep fs. The sum is kept to 16 bits: a stored sample is
+//                the 12-bit code times 2^min(n,4), ADC_SampleBits() bits wide. Summing 4^k
+//                results gains up to k bits of resolution on a noisy signal.
+// output:
+// 1 error
+// 0 success
+int ADC_SetAveraging(unsigned int hardwareLog2, unsigned int decimationLog2);
+unsigned int ADC_SampleBits(void);
+
 // Return status of ADC
 // 1 done
 // 0 busy
 int ADC_Status(void);
 
+// stops a collection early or ends streaming, ADCsamplesMax shrinks to the number of samples stored
+void ADC_Stop(void);
+
 // config gpio mux
 int ADC_Pin_Config(unsigned int channelNum);
 
@@ -82,4 +184,8 @@ int ADC_Pin_Config(unsigned int channelNum);
 // sequencer 3 with interrupt
 void ADC_Init(unsigned int channelNum);
 
+// config ADC for a list of channels
+// sequencers 0 and 1 with one interrupt at the end of the list
+void ADC_InitMulti(const uint8_t channels[], unsigned int numChannels);
+
 #endif
@@ -14,10 +14,12 @@ void WaitForInterrupt(void);  // low power mode
 // make sure that the prescaler is large enough to achieve the longest time
 // example for 16-bit timer
 // 2^16*(prescaler+1)/fbus=10.65ms so this is safe for fs=100 Hz
-// Output: N/A
-void Timer0_Init(unsigned int fsampling,uint32_t 	prescaler){
+// the period is rounded to the nearest count, the actual rate is fbus/(returned cycles)
+// Output: bus cycles between triggers, period*(prescaler+1)
+uint32_t Timer0_Init(unsigned int fsampling,uint32_t 	prescaler){
 	
-  uint32_t period = (uint32_t)(80000000/(fsampling*(prescaler+1)));  // period=fclk/(fs*(prescaler+1))
+  uint32_t divisor = fsampling*(prescaler+1);
+  uint32_t period = (80000000 + divisor/2)/divisor;  // period=fclk/(fs*(prescaler+1)), rounded
   DisableInterrupts();             // disable interrupt
   SYSCTL_RCGCTIMER_R |= 0x01;      // activate timer0 	
   while((SYSCTL_PRTIMER_R&SYSCTL_PRTIMER_R0)==0){} // allow time to finish activating
@@ -35,4 +37,5 @@ void Timer0_Init(unsigned int fsampling,uint32_t 	prescaler){
   //NVIC_PRI4_R = (NVIC_PRI4_R&0x00FFFFFF)|0x80000000; // 8) priority 4
   //NVIC_EN0_R = 1<<19;              // enable interrupt 17 in NVIC
   TIMER0_CTL_R |= 0x00000001;   // enable timer0A 16-b, periodic, interrupts
+  return period*(prescaler+1);
 }
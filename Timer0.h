@@ -8,4 +8,6 @@
 // make sure that the prescaler is large enough to achieve the longest time
 // example for 16-bit timer
 // 2^16*(prescaler+1)/fbus=10.65ms so this is safe for fs=100 Hz
-void Timer0_Init(unsigned int fsampling,uint32_t 	prescaler);
+// the period is rounded to the nearest count, the actual rate is fbus/(returned cycles)
+// Output: bus cycles between triggers, period*(prescaler+1)
+uint32_t Timer0_Init(unsigned int fsampling,uint32_t 	prescaler);
@@ -0,0 +1,207 @@
+#include "calib.h"
+#include "defs.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+// GP2Y0A21YK output (Vcc 5V) against distance, fitted to the datasheet curve as
+// d = 299.88mm * V^-1.173 and read with the 3.3V reference. The sensor is only specified from
+// 10 to 80cm, so the table is clamped there, and below 10cm the curve folds back (the output
+// peaks near 6cm), which the sensor can't tell apart from further readings.
+static const int16_t CALIB_Gp2y0a21[CALIB_LUT_POINTS] = {
+  800, 800, 800, 800, 800, 800, 800, 800, 800, 738, 652, 583, 527, 479, 440, 405,
+  376, 350, 327, 307, 289, 273, 259, 246, 234, 223, 213, 203, 195, 187, 180, 173,
+  167, 161, 155, 150, 145, 141, 136, 132, 128, 125, 121, 118, 115, 112, 109, 106,
+  104, 101, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+  100
+};
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+CALIB_Channel CALIB_Channels[CALIB_CHANNELS];
+int16_t CALIB_UserTable[CALIB_LUT_POINTS];
+
+const char* const CALIB_TableNames[CALIB_LUT_COUNT] = { "none", "gp2y0a21", "user" };
+static const char* const CALIB_TableUnits[CALIB_LUT_COUNT] = { "codes", "mm", "units" };
+
+static const int16_t* const CALIB_Tables[CALIB_LUT_COUNT] = { NULL, CALIB_Gp2y0a21, CALIB_UserTable };
+
+/*
+========================================================================================================================
+==========                                           CALIB FUNCTIONS                                          ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  CALIB :: CALIB_Clear
+
+   - no offset, unity gain and no table on every channel, the user table becomes a straight line
+===================================================================================================
+*/
+void CALIB_Clear(void){
+  for (int i = 0; i < CALIB_CHANNELS; i++){
+    CALIB_Channels[i].offset = 0;
+    CALIB_Channels[i].gain = CALIB_GAIN_ONE;
+    CALIB_Channels[i].table = CALIB_LUT_NONE;
+  }
+  for (int i = 0; i < CALIB_LUT_POINTS; i++){
+    CALIB_UserTable[i] = i << CALIB_LUT_SHIFT;
+  }
+}
+
+/*
+===================================================================================================
+  CALIB :: CALIB_Set
+
+   - sets a channel's offset (codes) and gain (Q2.14)
+   - return success value
+===================================================================================================
+*/
+int CALIB_Set(uint8_t channel, int16_t offset, uint16_t gain){
+  if (channel >= CALIB_CHANNELS || gain == 0){
+    return CMD_FAILURE;
+  }
+  CALIB_Channels[channel].offset = offset;
+  CALIB_Channels[channel].gain = gain;
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  CALIB :: CALIB_SetTable
+
+   - selects the table a channel's corrected codes go through
+   - return success value
+===================================================================================================
+*/
+int CALIB_SetTable(uint8_t channel, uint8_t table){
+  if (channel >= CALIB_CHANNELS || table >= CALIB_LUT_COUNT){
+    return CMD_FAILURE;
+  }
+  CALIB_Channels[channel].table = table;
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  CALIB :: CALIB_SetPoints
+
+   - writes count points of the user table from point first on, point i is the value at code
+     i*64 (the last one at 4096, a code never reached, is only used to interpolate)
+   - return success value
+===================================================================================================
+*/
+int CALIB_SetPoints(uint8_t first, const int16_t* points, uint8_t count){
+  if (first >= CALIB_LUT_POINTS || count > CALIB_LUT_POINTS - first){
+    return CMD_FAILURE;
+  }
+  for (int i = 0; i < count; i++){
+    CALIB_UserTable[first + i] = points[i];
+  }
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  CALIB :: CALIB_Enabled
+
+   - true if the channel's samples change when converted
+===================================================================================================
+*/
+bool CALIB_Enabled(uint8_t channel){
+  const CALIB_Channel* cal = &CALIB_Channels[channel];
+  return (cal->offset != 0 || cal->gain != CALIB_GAIN_ONE || cal->table != CALIB_LUT_NONE);
+}
+
+/*
+===================================================================================================
+  CALIB :: CALIB_Units
+
+   - name of the units a channel converts to
+===================================================================================================
+*/
+const char* CALIB_Units(uint8_t channel){
+  return CALIB_TableUnits[CALIB_Channels[channel].table];
+}
+
+/*
+===================================================================================================
+  CALIB :: lookup
+
+   - corrects a 12-bit code and interpolates it in the table (NULL for none)
+===================================================================================================
+*/
+static __inline int16_t lookup(int32_t code, int32_t offset, int32_t gain, const int16_t* table){
+  int32_t corrected = ((code - offset) * gain) >> CALIB_GAIN_SHIFT;
+  if (corrected < 0) corrected = 0;
+  if (corrected > 4095) corrected = 4095;
+  if (table == NULL){
+    return corrected;
+  }
+
+  const int16_t* point = &table[corrected >> CALIB_LUT_SHIFT];
+  int32_t fraction = corrected & ((1 << CALIB_LUT_SHIFT) - 1);
+  return point[0] + (((point[1] - point[0]) * fraction) >> CALIB_LUT_SHIFT);
+}
+
+/*
+===================================================================================================
+  CALIB :: CALIB_Convert
+
+   - converts one code from a channel into its units
+===================================================================================================
+*/
+int16_t CALIB_Convert(uint8_t channel, uint16_t code, unsigned int bits){
+  const CALIB_Channel* cal = &CALIB_Channels[channel];
+  return lookup(code >> (bits - 12), cal->offset, cal->gain, CALIB_Tables[cal->table]);
+}
+
+/*
+===================================================================================================
+  CALIB :: CALIB_Block
+
+   - converts a block of interleaved codes, values may be the same buffer as codes
+   - every channel's settings are fetched once per block, one channel runs a tighter loop
+===================================================================================================
+*/
+void CALIB_Block(const uint8_t* channels, uint8_t numChannels, const uint16_t* codes, int16_t* values,
+                 uint32_t length, unsigned int bits){
+  int32_t offset[CALIB_CHANNELS];
+  int32_t gain[CALIB_CHANNELS];
+  const int16_t* table[CALIB_CHANNELS];
+  unsigned int shift = bits - 12;
+
+  for (int i = 0; i < numChannels; i++){
+    const CALIB_Channel* cal = &CALIB_Channels[channels[i]];
+    offset[i] = cal->offset;
+    gain[i] = cal->gain;
+    table[i] = CALIB_Tables[cal->table];
+  }
+
+  if (numChannels == 1){
+    for (uint32_t i = 0; i < length; i++){
+      values[i] = lookup(codes[i] >> shift, offset[0], gain[0], table[0]);
+    }
+    return;
+  }
+
+  unsigned int k = 0;
+  for (uint32_t i = 0; i < length; i++){
+    values[i] = lookup(codes[i] >> shift, offset[k], gain[k], table[k]);
+    if (++k == numChannels){
+      k = 0;
+    }
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef CALIB_H
+#define CALIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Per-channel calibration and linearization of 12-bit ADC codes into engineering units, in
+// fixed point and cheap enough for every sample of a stream:
+//   corrected = ((code - offset) * gain) >> 14         gain Q2.14, clamped to 0-4095
+//   value     = lut[i] + ((lut[i+1] - lut[i]) * f) >> 6    i = corrected >> 6, f = corrected & 63
+// A table holds CALIB_LUT_POINTS points, one every 64 codes, so a lookup is a shift, two loads
+// and a multiply. A channel without a table reads as its corrected code.
+
+#define CALIB_CHANNELS    12
+#define CALIB_LUT_SHIFT   6
+#define CALIB_LUT_POINTS  ((4096 >> CALIB_LUT_SHIFT) + 1)
+#define CALIB_GAIN_SHIFT  14
+#define CALIB_GAIN_ONE    (1 << CALIB_GAIN_SHIFT)
+
+// tables
+#define CALIB_LUT_NONE    0
+#define CALIB_LUT_GP2Y0A21 1          // Sharp GP2Y0A21YK IR ranger, mm (10-80cm, datasheet curve)
+#define CALIB_LUT_USER    2           // loaded with CALIB_SetPoints
+#define CALIB_LUT_COUNT   3
+
+typedef struct {
+  int16_t offset;                     // codes subtracted first
+  uint16_t gain;                      // Q2.14, CALIB_GAIN_ONE is 1
+  uint8_t table;                      // CALIB_LUT_*
+} CALIB_Channel;
+
+extern CALIB_Channel CALIB_Channels[CALIB_CHANNELS];
+extern int16_t CALIB_UserTable[CALIB_LUT_POINTS];
+extern const char* const CALIB_TableNames[CALIB_LUT_COUNT];
+
+// configuration, return success value
+int CALIB_Set(uint8_t channel, int16_t offset, uint16_t gain);
+int CALIB_SetTable(uint8_t channel, uint8_t table);
+int CALIB_SetPoints(uint8_t first, const int16_t* points, uint8_t count);
+void CALIB_Clear(void);               // every channel back to raw codes
+
+bool CALIB_Enabled(uint8_t channel);  // false while a channel reads as raw codes
+const char* CALIB_Units(uint8_t channel);
+
+// converts one code of bits (12-16, see ADC_SampleBits) from a channel
+int16_t CALIB_Convert(uint8_t channel, uint16_t code, unsigned int bits);
+
+// converts length interleaved codes, sample i is from channels[i % numChannels]
+void CALIB_Block(const uint8_t* channels, uint8_t numChannels, const uint16_t* codes, int16_t* values,
+                 uint32_t length, unsigned int bits);
+
+#endif
@@ -4,6 +4,25 @@
 #include "debug.h"
 #include "st7735.h"
 #include "pwm.h"
+#include "frame.h"
+#include "log.h"
+#include "usb_uart.h"
+#include "uart.h"
+#include "script.h"
+#include "jobs.h"
+#include "params.h"
+#include "scope.h"
+#include "scan.h"
+#include "filter.h"
+#include "fft.h"
+#include "stats.h"
+#include "pack.h"
+#include "calib.h"
+#include "compare.h"
+
+// prototypes for functions defined in startup.s
+long StartCritical (void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
 
 /*
 ========================================================================================================================
@@ -13,28 +32,296 @@
 
 volatile bool ledTogglerEnabled = false;
 
+// number of entries in each command table, filled in by CMD_Init
+uint16_t CMD_MainCount = 0;
+static uint16_t setCount = 0;
+static uint16_t getCount = 0;
+static uint16_t runCount = 0;
+static uint16_t scriptCount = 0;
+
+// reasons adcStartCollection can refuse to start
+#define ADC_START_OK        0
+#define ADC_START_CHANNEL   1
+#define ADC_START_FREQUENCY 2
+#define ADC_START_MEMORY    3
+#define ADC_START_BUSY      4
+#define ADC_START_JOBS      5
+
+// the heap is empty, captures go into one static buffer that the last capture owns
+#define ADC_MAX_SAMPLES 4096
+
+// conversions per second the ADC can do, and sequencer 3 interrupts per second we allow
+#define ADC_MAX_CONVERSIONS 1000000
+#define ADC_MAX_INTERRUPTS  125000
+static uint16_t adcBuffer[ADC_MAX_SAMPLES];
+
+// bits per sample and sample rate of the last capture if it holds one channel in time order,
+// captureBits is 0 if it doesn't (run filterCapture and run fft need that)
+static unsigned int captureBits = 0;
+static uint32_t captureRate = 0;
+
+// channels of the last capture in the order they are interleaved, captureChannelCount is 0 if
+// the capture isn't a plain interleaved list (run calCapture needs one)
+static uint8_t captureChannels[ADC_SCAN_MAX];
+static uint8_t captureChannelCount = 0;
+
+// samples per chunk run packTest asks for
+#define PACK_TEST_SAMPLES 256
+
+// spectrum of the last run fft, fftPoints/2 magnitudes
+static int16_t fftBuffer[FFT_MAX_POINTS];
+static uint32_t fftPoints = 0;
+static uint32_t fftRate = 0;
+
+static int adcStartCollection(const uint8_t* channels, int numChannels, int frequency, int numSamples, uint8_t* job);
+static int adcReportStart(int reason, uint8_t job);
+static int parseChannelList(const char* text, uint8_t* channels);
+static int parseScanList(const char* text, SCAN_Entry* list);
+static int parseValueList(char* text, int16_t* values, int max);
+static void setCaptureChannels(const uint8_t* channels, int numChannels);
+static void adcStreamConsumer(uint16_t* block, uint32_t length, const ADC_BlockHeader* header);
+static void printHeaderFlags(uint8_t flags);
+
+// last streaming block seen by adcStreamConsumer
+static volatile struct {
+  uint16_t min;
+  uint16_t max;
+  uint16_t mean;
+} streamStats;
+static ADC_BlockHeader streamHeader;
+
+// streamed channels, and with calibration on, every block converted and each channel's mean
+static uint8_t streamChannels[ADC_SCAN_MAX];
+static uint8_t streamChannelCount;
+static bool streamCalibrated;
+static int16_t streamValues[ADC_STREAM_BLOCK];
+static volatile int16_t streamUnits[ADC_SCAN_MAX];
+static int adcJobPoll(void);
+static int ledTogglerJobPoll(void);
+static void ledTogglerJobKill(void);
+static uint8_t ledTogglerStart(uint32_t period);
+
+// parameter apply functions (see PARAM_Table)
+static bool pwmRunning = false;
+static void pwmEnableApply(int32_t enable);
+static void pwmFreqApply(int32_t frequency);
+static void pwmDutyApply(int32_t duty);
+static void ledPeriodApply(int32_t period);
+static void adcAutostartApply(int32_t autostart);
+static void adcAverageApply(int32_t unused);
+
 /*
 ========================================================================================================================
 ==========                                           COMMAND ARRAYS                                           ==========
 ========================================================================================================================
 */
 
+// argument schemas (see ArgSpec)
+static const ArgSpec pwmFreqArgs[] = {
+  { ARG_INT, "frequency", 625, 99999, "Hz" },
+  { ARG_END }
+};
+static const ArgSpec pwmDutyArgs[] = {
+  { ARG_INT, "duty cycle", 0, 99, "%" },
+  { ARG_END }
+};
+static const ArgSpec logLevelArgs[] = {
+  { ARG_WORD, "module or all", 0, 0, "" },
+  { ARG_WORD, "level", 0, 0, "none,error,warn,info,debug" },
+  { ARG_END }
+};
+static const ArgSpec flowControlArgs[] = {
+  { ARG_INT, "port", 0, UART_NUM_PORTS - 1, "" },
+  { ARG_WORD, "mode", 0, 0, "none,xonxoff" },
+  { ARG_END }
+};
+static const ArgSpec portArgs[] = {
+  { ARG_INT, "port", 0, UART_NUM_PORTS - 1, "" },
+  { ARG_END }
+};
+static const ArgSpec adcCollectArgs[] = {
+  { ARG_INT, "channel", 0, 11, "" },
+  { ARG_INT, "frequency", 100, 10000, "Hz" },
+  { ARG_INT, "numSamples", 1, ADC_MAX_SAMPLES, "" },
+  { ARG_END }
+};
+static const ArgSpec adcMultiArgs[] = {
+  { ARG_WORD, "channels", 0, 0, "up to 12, e.g. 0,1,1,5" },
+  { ARG_INT, "frequency", 100, 10000, "Hz" },
+  { ARG_INT, "numSamples", 1, ADC_MAX_SAMPLES, "per channel" },
+  { ARG_END }
+};
+static const ArgSpec adcStreamArgs[] = {
+  { ARG_WORD, "channels", 0, 0, "1, 2, 4 or 8, e.g. 0,1" },
+  { ARG_INT, "frequency", 100, 1000000, "Hz" },
+  { ARG_END }
+};
+static const ArgSpec adcScanArgs[] = {
+  { ARG_WORD, "channels", 0, 0, "up to 12 channel:decimation, e.g. 0:1,3:10" },
+  { ARG_INT, "frequency", 100, ADC_MAX_INTERRUPTS, "Hz base" },
+  { ARG_INT, "triggers", 1, 1000000, "base samples" },
+  { ARG_END }
+};
+static const ArgSpec scopeArgs[] = {
+  { ARG_INT, "channel", 0, 11, "" },
+  { ARG_INT, "frequency", 100, 1000000, "Hz" },
+  { ARG_INT, "level", 0, 4095, "" },
+  { ARG_WORD, "slope", 0, 0, "rising,falling,either" },
+  { ARG_INT, "pre", 0, ADC_MAX_SAMPLES - 1, "samples" },
+  { ARG_INT, "post", 1, ADC_MAX_SAMPLES, "samples" },
+  { ARG_END }
+};
+static const ArgSpec adcAverageArgs[] = {
+  { ARG_INT, "hardware", 1, 1 << ADC_MAX_HW_AVERAGE, "x, power of 2" },
+  { ARG_INT, "decimation", 1, 1 << ADC_MAX_DECIMATION, "x, power of 2" },
+  { ARG_END }
+};
+static const ArgSpec adcDualArgs[] = {
+  { ARG_INT, "channel0", 0, 11, "ADC0" },
+  { ARG_INT, "channel1", 0, 11, "ADC1" },
+  { ARG_INT, "frequency", 100, ADC_MAX_INTERRUPTS, "Hz" },
+  { ARG_INT, "numPairs", 1, ADC_MAX_SAMPLES / 2, "" },
+  { ARG_INT, "phase", 0, 15, "/16 conversion" },
+  { ARG_END }
+};
+static const ArgSpec filterTapsArgs[] = {
+  { ARG_INT, "first", 0, FILTER_MAX_TAPS - 1, "tap" },
+  { ARG_WORD, "taps", 0, 0, "Q15, e.g. 8192,16384,8192" },
+  { ARG_END }
+};
+static const ArgSpec filterBiquadArgs[] = {
+  { ARG_INT, "stage", 0, FILTER_MAX_BIQUADS - 1, "" },
+  { ARG_FIXED, "b0", -1999, 1999, "" },
+  { ARG_FIXED, "b1", -1999, 1999, "" },
+  { ARG_FIXED, "b2", -1999, 1999, "" },
+  { ARG_FIXED, "a1", -1999, 1999, "" },
+  { ARG_FIXED, "a2", -1999, 1999, "" },
+  { ARG_END }
+};
+static const ArgSpec filterAverageArgs[] = {
+  { ARG_INT, "length", 1, FILTER_MAX_AVERAGE, "samples" },
+  { ARG_END }
+};
+static const ArgSpec filterDecimateArgs[] = {
+  { ARG_INT, "factor", 1, FILTER_MAX_DECIMATE, "" },
+  { ARG_END }
+};
+static const ArgSpec fftArgs[] = {
+  { ARG_INT, "points", FFT_MIN_POINTS, FFT_MAX_POINTS, "power of 2" },
+  { ARG_WORD, "window", 0, 0, "rectangle,hann,hamming" },
+  { ARG_WORD, "plot", 0, 0, "none,bar,dB" },
+  { ARG_END }
+};
+static const ArgSpec adcStatsArgs[] = {
+  { ARG_INT, "block", 1, 1000000, "samples" },
+  { ARG_INT, "level", 0, 65535, "zero crossing code" },
+  { ARG_INT, "hysteresis", 0, 32767, "codes" },
+  { ARG_END }
+};
+static const ArgSpec adcCalArgs[] = {
+  { ARG_INT, "channel", 0, CALIB_CHANNELS - 1, "" },
+  { ARG_INT, "offset", -4095, 4095, "codes" },
+  { ARG_FIXED, "gain", 1, 3999, "x" },
+  { ARG_END }
+};
+static const ArgSpec adcLutArgs[] = {
+  { ARG_INT, "channel", 0, CALIB_CHANNELS - 1, "" },
+  { ARG_WORD, "table", 0, 0, "none,gp2y0a21,user" },
+  { ARG_END }
+};
+static const ArgSpec adcLutPointsArgs[] = {
+  { ARG_INT, "first", 0, CALIB_LUT_POINTS - 1, "point" },
+  { ARG_WORD, "points", 0, 0, "values at codes 64 apart, e.g. 800,738,652" },
+  { ARG_END }
+};
+static const ArgSpec adcWatchArgs[] = {
+  { ARG_INT, "watch", 0, COMPARE_MAX - 1, "" },
+  { ARG_INT, "channel", 0, 11, "" },
+  { ARG_WORD, "region", 0, 0, "above,below" },
+  { ARG_INT, "level", 1, 4095, "" },
+  { ARG_INT, "hysteresis", 0, 4094, "codes" },
+  { ARG_END }
+};
+static const ArgSpec adcUnwatchArgs[] = {
+  { ARG_INT, "watch", 0, COMPARE_MAX - 1, "" },
+  { ARG_END }
+};
+static const ArgSpec packTestArgs[] = {
+  { ARG_WORD, "mode", 0, 0, "raw,12bit,rice" },
+  { ARG_END }
+};
+static const ArgSpec ledTogglerArgs[] = {
+  { ARG_INT, "period", 1, 999999, "ms" },
+  { ARG_END }
+};
+static const ArgSpec jobArgs[] = {
+  { ARG_INT, "job", 1, 255, "" },
+  { ARG_END }
+};
+static const ArgSpec paramArgs[] = {
+  { ARG_WORD, "name", 0, 0, "see get params" },
+  { ARG_INT, "value", -2147483647 - 1, 2147483647, "" },
+  { ARG_END }
+};
+static const ArgSpec uartOpenArgs[] = {
+  { ARG_INT, "port", 0, UART_NUM_PORTS - 1, "" },
+  { ARG_INT, "baud", 300, 5000000, "" },
+  { ARG_WORD, "flow", 0, 0, "none,xonxoff,rtscts" },
+  { ARG_END }
+};
+static const ArgSpec uartSendArgs[] = {
+  { ARG_INT, "port", 0, UART_NUM_PORTS - 1, "" },
+  { ARG_WORD, "text", 0, 0, "" },
+  { ARG_END }
+};
+
+// persistent parameters, in id order (see params.h)
+const Param PARAM_Table[PARAM_COUNT] = {
+  { "pwmEnable", 0, 1, 0, pwmEnableApply },
+  { "pwmFreq", 625, 99999, 1000, pwmFreqApply },
+  { "pwmDuty", 0, 99, 50, pwmDutyApply },
+  { "ledPeriod", 0, 999999, 0, ledPeriodApply },
+  { "adcChannel", 0, 11, 0, NULL },
+  { "adcFrequency", 100, 10000, 1000, NULL },
+  { "adcSamples", 1, ADC_MAX_SAMPLES, 1000, NULL },
+  { "adcAutostart", 0, 1, 0, adcAutostartApply },
+  { "adcHwAverage", 0, ADC_MAX_HW_AVERAGE, 0, adcAverageApply },
+  { "adcDecimation", 0, ADC_MAX_DECIMATION, 0, adcAverageApply },
+};
+
 // array of main commands
 Command mainCommands[] = { 
   { "set", setHandler, setCommands, "[listed variable] : sets an environment variable"},
   { "get", getHandler, getCommands, "[listed variable] : returns an environment variable"},
   { "run", runHandler, runCommands, "[listed command] : runs a command"},
-  { "help", helpHandler, NULL, "[set,get,run] : prints help text"},
+  { "script", scriptHandler, scriptCommands, "[listed command] : stores and runs blocks of commands"},
+  { "help", helpHandler, NULL, "[set,get,run,script] : prints help text"},
+  { "jobs", jobsHandler, NULL, ": lists background jobs"},
+  { "wait", waitHandler, NULL, "[job] : waits for a background job to finish (a new line stops waiting)", jobArgs},
+  { "kill", killHandler, NULL, "[job] : stops a background job", jobArgs},
 
   { 0, NULL, NULL, 0} // array terminator
 };
 
 // array of set commands
 Command setCommands[] = { 
-  { "pwmFreq", pwmFreqSetter, NULL, "[frequency] : sets PWM0A frequency"},
+  { "pwmFreq", pwmFreqSetter, NULL, ": sets PWM0A frequency", pwmFreqArgs},
   //{ "pwmPeriod", pwmPeriodHandler, NULL, "[period] : sets PWM0A period (in 25ns units)"},
-  { "pwmDuty", pwmDutySetter, NULL, "[duty cycle] : sets PWM0A duty cycle (in integer percent)"},
+  { "pwmDuty", pwmDutySetter, NULL, ": sets PWM0A duty cycle (in integer percent)", pwmDutyArgs},
   //{ "pwmDutyTime", pwmDutyTimeHandler, NULL, "[duty time] : sets PWM0A duty time (in 25ns units)"},
+  { "logLevel", logLevelSetter, NULL, ": sets runtime log level", logLevelArgs},
+  { "flowControl", flowControlSetter, NULL, ": sets UART flow control", flowControlArgs},
+  { "telemetryPort", telemetryPortSetter, NULL, ": sends binary telemetry frames over an open UART", portArgs},
+  { "param", paramSetter, NULL, ": sets a stored parameter (run paramSave to keep it)", paramArgs},
+  { "adcAverage", adcAverageSetter, NULL, ": sets hardware oversampling and adcCollect decimation", adcAverageArgs},
+  { "adcStats", adcStatsSetter, NULL, ": sets the statistics block length and zero crossing band, starting over", adcStatsArgs},
+  { "filterTaps", filterTapsSetter, NULL, ": writes FIR taps from tap first on, first 0 starts a new set", filterTapsArgs},
+  { "filterBiquad", filterBiquadSetter, NULL, ": sets or appends a biquad stage", filterBiquadArgs},
+  { "filterAverage", filterAverageSetter, NULL, ": sets the moving average length, 1 is off", filterAverageArgs},
+  { "filterDecimate", filterDecimateSetter, NULL, ": keeps one of every factor filtered samples", filterDecimateArgs},
+  { "adcCal", adcCalSetter, NULL, ": sets a channel's offset and gain", adcCalArgs},
+  { "adcLut", adcLutSetter, NULL, ": sets the table a channel's codes are converted with", adcLutArgs},
+  { "adcLutPoints", adcLutPointsSetter, NULL, ": writes user table points from point first on", adcLutPointsArgs},
 
   { 0, NULL, NULL, 0} // array terminator
 };
@@ -42,21 +329,75 @@ Command setCommands[] = {
 // array of get commands
 Command getCommands[] = { 
   { "pwmFreq", pwmFreqGetter, NULL, ": gets current PWM0A frequency"},
+  { "logLevel", logLevelGetter, NULL, ": lists runtime log level of every module"},
+  { "uartStats", uartStatsGetter, NULL, ": gets error and drop counters of every open UART"},
+  { "params", paramsGetter, NULL, ": lists stored parameters, * marks unsaved changes"},
+  { "adcStream", adcStreamGetter, NULL, ": gets block counts and the last block's min/max/mean of adcStream"},
+  { "scope", scopeGetter, NULL, ": gets the scope's state and trigger position"},
+  { "adcStats", adcStatsGetter, NULL, ": gets min/max/mean/rms/crossings of the last block and the whole capture"},
+  { "filter", filterGetter, NULL, ": lists the filter stages"},
+  { "spectrum", spectrumGetter, NULL, ": lists every bin of the last fft"},
+  { "adcScan", adcScanGetter, NULL, ": gets the rate, sample count and buffer offset of every adcScan channel"},
+  { "adcInfo", adcInfoGetter, NULL, ": gets the last capture's start time, exact period, actual rate and flags"},
+  { "adcCal", adcCalGetter, NULL, ": lists every calibrated channel and the user table"},
+  { "adcWatch", adcWatchGetter, NULL, ": lists the comparator watches and their event counts"},
     
   { 0, NULL, NULL, 0} // array terminator
 };
 
 // array of run commands
 Command runCommands[] = {
-  { "adcCollect", adcTestHandler, NULL, "[channelNum] [frequency] [numSamples] : runs adc collection"},
-  { "ledToggler", ledTogglerHandler, NULL, "[frequency in ms] : turns on led periodic task"},
+  { "adcCollect", adcTestHandler, NULL, ": starts adc collection as a background job", adcCollectArgs},
+  { "adcMulti", adcMultiHandler, NULL, ": samples a list of channels on every trigger (SS0) as a background job", adcMultiArgs},
+  { "adcStream", adcStreamHandler, NULL, ": streams a list of channels through uDMA until killed", adcStreamArgs},
+  { "adcScan", adcScanHandler, NULL, ": samples a list of channels, each with its own decimation, as a background job", adcScanArgs},
+  { "adcDual", adcDualHandler, NULL, ": samples two channels at once on ADC0 and ADC1 as a background job", adcDualArgs},
+  { "scope", scopeHandler, NULL, ": captures pre/post samples around a level crossing as a background job", scopeArgs},
+  { "ledToggler", ledTogglerHandler, NULL, ": starts led periodic task as a background job", ledTogglerArgs},
   { "ledDisabler", ledDisablerHandler, NULL, ": turns off led periodic task"},
   { "helloTop", helloTopScreenHandler, NULL, ": says hello from the top screen"},
   { "helloBottom", helloBottomScreenHandler, NULL, ": says hello from the bottom screen"},
+  { "uartOpen", uartOpenHandler, NULL, ": opens UART0-7 (rtscts on UART1 only)", uartOpenArgs},
+  { "uartSend", uartSendHandler, NULL, ": prints text on an open UART", uartSendArgs},
+  { "paramSave", paramSaveHandler, NULL, ": writes changed parameters to EEPROM"},
+  { "paramLoad", paramLoadHandler, NULL, ": reloads and applies the parameters in EEPROM"},
+  { "paramDefaults", paramDefaultsHandler, NULL, ": applies default parameters (run paramSave to keep them)"},
+  { "filterClear", filterClearHandler, NULL, ": turns every filter stage off"},
+  { "filterCapture", filterCaptureHandler, NULL, ": runs the last one channel capture through the filter"},
+  { "calCapture", calCaptureHandler, NULL, ": converts the last capture to calibrated units in place"},
+  { "adcWatch", adcWatchHandler, NULL, ": reports when a channel enters or leaves a region, using no CPU meanwhile", adcWatchArgs},
+  { "adcUnwatch", adcUnwatchHandler, NULL, ": stops a comparator watch", adcUnwatchArgs},
+  { "packTest", packTestHandler, NULL, ": compresses the last capture in frame sized chunks and checks it decodes", packTestArgs},
+  { "fft", fftHandler, NULL, ": finds the spectrum peaks of the last one channel capture, optionally plotted", fftArgs},
+
+  { 0, NULL, NULL, 0} // array terminator
+};
+
+// array of script commands
+Command scriptCommands[] = {
+  { "begin", scriptBeginHandler, NULL, ": stores the following lines, up to \"end\", as the script"},
+  { "run", scriptRunHandler, NULL, ": runs the script, timing each command"},
+  { "list", scriptListHandler, NULL, ": prints the script"},
+  { "clear", scriptClearHandler, NULL, ": empties the script"},
+  { "save", scriptSaveHandler, NULL, ": saves the script to EEPROM"},
+  { "load", scriptLoadHandler, NULL, ": loads the script from EEPROM"},
 
   { 0, NULL, NULL, 0} // array terminator
 };
 
+// array of binary frame commands (see frame.h for payload layouts)
+FrameCommand frameCommands[] = {
+  { FRAME_PING, pingFrameHandler, "[any] : echoes the payload"},
+  { FRAME_SET, setFrameHandler, "[param] [value] : sets an environment variable"},
+  { FRAME_GET, getFrameHandler, "[param] : returns an environment variable"},
+  { FRAME_RUN, runFrameHandler, "[command] [args] : runs a command"},
+  { FRAME_SAMPLES, samplesFrameHandler, "[offset] [count] : returns raw samples from the last capture"},
+  { FRAME_PACKED, packedFrameHandler, "[offset] [count] [mode] : returns compressed samples from the last capture"},
+  { FRAME_INFO, infoFrameHandler, ": returns the last capture's header"},
+
+  { 0, NULL, 0} // array terminator
+};
+
 /*
 ========================================================================================================================
 ==========                                     COMMAND HANDLER FUNCTIONS                                      ==========
@@ -71,21 +412,17 @@ Command runCommands[] = {
    - return success value
 ===================================================================================================
 */
-int setHandler(char** tokens, uint8_t numTokens){
-  int i = 0;
+int setHandler(CmdArgs* args){
   //printf ("you made it to setHandler!\n");
-  if (numTokens < 2){
+  if (args->count < 1){
     printf("ERROR: SET needs more args.\n\n");
     printf("Available SET commands:\n");
     printHelp(setCommands, " ");
     return CMD_FAILURE;
   }
-  while (setCommands[i].function != NULL){      // the setCommands array 
-    if (strcmp(tokens[1], setCommands[i].key) == 0){
-      setCommands[i].function(tokens, numTokens);
-      return CMD_SUCCESS;
-    }
-    i++;
+  Command* command = CMD_Lookup(setCommands, setCount, args->arg[0]);
+  if (command != NULL){
+    return CMD_Execute(command, args->tokens, args->numTokens, 2);
   }
   printf("ERROR: No matching SET command found.\n");
   return CMD_FAILURE;}
@@ -98,21 +435,17 @@ int setHandler(char** tokens, uint8_t numTokens){
    - return success value
 ===================================================================================================
 */
-int getHandler(char** tokens, uint8_t numTokens){
-  int i = 0;
+int getHandler(CmdArgs* args){
   //printf ("you made it to getHandler!\n");
-  if (numTokens < 2){
+  if (args->count < 1){
     printf("ERROR: GET needs more args.\n\n");
     printf("Available GET commands:\n");
     printHelp(getCommands, " ");
     return CMD_FAILURE;
   }
-  while (getCommands[i].function != NULL){      // the getCommands array 
-    if (strcmp(tokens[1], getCommands[i].key) == 0){
-      getCommands[i].function(tokens, numTokens);
-      return CMD_SUCCESS;
-    }
-    i++;
+  Command* command = CMD_Lookup(getCommands, getCount, args->arg[0]);
+  if (command != NULL){
+    return CMD_Execute(command, args->tokens, args->numTokens, 2);
   }
   printf("ERROR: No matching GET command found.\n");
   return CMD_FAILURE;
@@ -126,26 +459,45 @@ int getHandler(char** tokens, uint8_t numTokens){
    - return success value
 ===================================================================================================
 */
-int runHandler(char** tokens, uint8_t numTokens){
-  int i = 0;
+int runHandler(CmdArgs* args){
   //printf ("you made it to runHandler!\n");
-  if (numTokens < 2){
+  if (args->count < 1){
     printf("ERROR: RUN needs more args.\n\n");
     printf("Available run commands:\n");
     printHelp(runCommands, " ");
     return CMD_FAILURE;
   }
-  while (runCommands[i].function != NULL){      // the runCommands array 
-    if (strcmp(tokens[1], runCommands[i].key) == 0){
-      runCommands[i].function(tokens, numTokens);
-      return CMD_SUCCESS;
-    }
-    i++;
+  Command* command = CMD_Lookup(runCommands, runCount, args->arg[0]);
+  if (command != NULL){
+    return CMD_Execute(command, args->tokens, args->numTokens, 2);
   }
   printf("ERROR: No matching RUN command found.\n");
   return CMD_FAILURE;
 }
 
+/*
+===================================================================================================
+  COMMAND HANDLER :: scriptHandler
+  
+   - parses for script commands and attempts to execute them
+   - return success value
+===================================================================================================
+*/
+int scriptHandler(CmdArgs* args){
+  if (args->count < 1){
+    printf("ERROR: SCRIPT needs more args.\n\n");
+    printf("Available SCRIPT commands:\n");
+    printHelp(scriptCommands, " ");
+    return CMD_FAILURE;
+  }
+  Command* command = CMD_Lookup(scriptCommands, scriptCount, args->arg[0]);
+  if (command != NULL){
+    return CMD_Execute(command, args->tokens, args->numTokens, 2);
+  }
+  printf("ERROR: No matching SCRIPT command found.\n");
+  return CMD_FAILURE;
+}
+
 /*
 ===================================================================================================
   COMMAND HANDLER :: helpHandler
@@ -154,17 +506,15 @@ int runHandler(char** tokens, uint8_t numTokens){
    - return success value
 ===================================================================================================
 */
-int helpHandler(char** tokens, uint8_t numTokens){
+int helpHandler(CmdArgs* args){
   int i = 0;
   //printf ("you made it to helpHandler!\n");
-  if (numTokens > 1){
-    while (mainCommands[i].function != NULL){
-      if ((strcmp(tokens[1], mainCommands[i].key) == 0) && (mainCommands[i].childArray != NULL)){
-        printHelp(mainCommands[i].childArray, " ");
-        printf("\n");
-        return CMD_SUCCESS;
-      }
-      i++;
+  if (args->count > 0){
+    Command* command = CMD_Lookup(mainCommands, CMD_MainCount, args->arg[0]);
+    if (command != NULL && command->childArray != NULL){
+      printHelp(command->childArray, " ");
+      printf("\n");
+      return CMD_SUCCESS;
     }
   } else {
     printf("\nAvailable commands:\n\n");
@@ -180,6 +530,44 @@ int helpHandler(char** tokens, uint8_t numTokens){
     
   return CMD_FAILURE;
 }
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: jobsHandler
+  
+   - lists background jobs and their state
+   - return success value
+===================================================================================================
+*/
+int jobsHandler(CmdArgs* args){
+  JOB_List();
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: waitHandler
+  
+   - blocks until a background job finishes or a new line arrives
+   - return success value
+===================================================================================================
+*/
+int waitHandler(CmdArgs* args){
+  // job id was range checked against jobArgs
+  return JOB_Wait(args->value[0]);
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: killHandler
+  
+   - stops a background job
+   - return success value
+===================================================================================================
+*/
+int killHandler(CmdArgs* args){
+  return JOB_Kill(args->value[0]);
+}
     
 /*
 ===================================================================================================
@@ -189,27 +577,11 @@ int helpHandler(char** tokens, uint8_t numTokens){
    - return success value
 ===================================================================================================
 */
-int pwmFreqSetter(char** tokens, uint8_t numTokens){
-  // verify correct number of argument tokens, show help if invalid
-  if (numTokens < 3) {
-    printf("ERROR: Incorrect number of args.\n\n");
-    printf("  Usage: set pwmFreq [frequency]\n\n");
-    return CMD_FAILURE;
-  }
-  
-  // attempt to parse arguments
-  int frequency = atoi(tokens[2]);
-  
-  // verify frequency range and set if valid
-  if (frequency >= 625 && frequency < 100000){
-    printf("  Setting PWM0A frequency to %dHz...\n\n", frequency);
-    PWM0A_SetFrequency(frequency);
-  } else {
-    // print error and fail
-    printf("ERROR: pwmFreq must be between 625 and 100,000.\n");
-    return CMD_FAILURE;
-  }
-  return CMD_SUCCESS;
+int pwmFreqSetter(CmdArgs* args){
+  // frequency was range checked against pwmFreqArgs
+  int frequency = args->value[0];
+  printf("  Setting PWM0A frequency to %dHz...\n\n", frequency);
+  return PARAM_Set(PARAM_PWM_FREQ, frequency);
 }
 
 /*
@@ -220,7 +592,7 @@ int pwmFreqSetter(char** tokens, uint8_t numTokens){
    - return success value
 ===================================================================================================
 */
-int pwmPeriodHandler(char** tokens, uint8_t numTokens){
+int pwmPeriodHandler(CmdArgs* args){
   // NYI
   return CMD_SUCCESS;
 }
@@ -233,27 +605,11 @@ int pwmPeriodHandler(char** tokens, uint8_t numTokens){
    - return success value
 ===================================================================================================
 */
-int pwmDutySetter(char** tokens, uint8_t numTokens){
-  // verify correct number of argument tokens, show help if invalid
-  if (numTokens < 3) {
-    printf("ERROR: Incorrect number of args.\n\n");
-    printf("  Usage: set pwmDuty [percent]\n\n");
-    return CMD_FAILURE;
-  }
-  
-  // attempt to parse arguments
-  int duty = atoi(tokens[2]);
-  
-  // verify frequency range and set if valid
-  if (duty >= 0 && duty < 99){
-    printf("  Setting PWM0A duty cycle to %d%%...\n\n", duty);
-    PWM0A_SetDutyPercent(duty);
-  } else {
-    // print error and fail
-    printf("ERROR: Duty cycle must be betwee 0 and 99.\n\n");
-    return CMD_FAILURE;
-  }
-  return CMD_SUCCESS;
+int pwmDutySetter(CmdArgs* args){
+  // duty was range checked against pwmDutyArgs
+  int duty = args->value[0];
+  printf("  Setting PWM0A duty cycle to %d%%...\n\n", duty);
+  return PARAM_Set(PARAM_PWM_DUTY, duty);
 }
 
 /*
@@ -264,7 +620,7 @@ int pwmDutySetter(char** tokens, uint8_t numTokens){
    - return success value
 ===================================================================================================
 */
-int pwmDutyTimeHandler(char** tokens, uint8_t numTokens){
+int pwmDutyTimeHandler(CmdArgs* args){
     // NYI
     return CMD_SUCCESS;
 }    
@@ -273,175 +629,2231 @@ int pwmDutyTimeHandler(char** tokens, uint8_t numTokens){
 ===================================================================================================
   COMMAND HANDLER :: adcTestHandler
   
-   - parses the command line and begins a adc sampler task
+   - parses the command line and begins a adc sampler task in the background
    - return success value
 ===================================================================================================
 */
-int adcTestHandler(char** tokens, uint8_t numTokens){
-  // verify correct number of argument tokens, show help if invalid
-  if (numTokens < 5) {
-    printf("ERROR: Incorrect number of args.\n\n");
-    printf("  Usage: adcCollect [channel, 0-11] [frequency, 100-10000] [numSamples]\n\n");
-    return CMD_FAILURE;
-  }
-
-  // attempt to parse arguments
-  int channel = atoi(tokens[2]);
-  int frequency = atoi(tokens[3]);
-  int numSamples = atoi(tokens[4]);
+int adcTestHandler(CmdArgs* args){
+  // arguments were range checked against adcCollectArgs
+  int channel = args->value[0];
+  int frequency = args->value[1];
+  int numSamples = args->value[2];
 
   //printf("channel = %d, freq = %d, numSamples = %d\n", channel, frequency, numSamples);
 
-  // verify channel range
-  if (channel < 0 || channel > 11){
-    printf("ERROR: Channel number out of range!\n\n");
-    return CMD_FAILURE;
-  } 
-  
-  // verify frequency range
-  if (frequency < 100 || frequency > 10000){
-    printf("ERROR: Sample frequency out of range!\n\n");
-    return CMD_FAILURE;
-  } 
+  uint8_t list = channel;
+  uint8_t job;
+  int reason = adcStartCollection(&list, 1, frequency, numSamples, &job);   // job is only set once this returns
+  return adcReportStart(reason, job);
+}
 
-  // attempt to malloc a buffer, complain and fail if memory unavailable
-  ADCBufferPointer = malloc(numSamples * sizeof(*ADCBufferPointer));
-  if (ADCBufferPointer == NULL){
-    printf("ERROR: Could not allocate sample buffer memory!\n\n");
+/*
+===================================================================================================
+  COMMAND HANDLER :: adcMultiHandler
+  
+   - parses a comma separated channel list and samples all of them on every trigger
+   - return success value
+===================================================================================================
+*/
+int adcMultiHandler(CmdArgs* args){
+  uint8_t channels[ADC_SCAN_MAX];
+  int numChannels = parseChannelList(args->arg[0], channels);
+  if (numChannels == 0){
     return CMD_FAILURE;
-  } 
-    
-  // start adc collection task
-  ADC_Collect(channel, frequency, ADCBufferPointer, numSamples);
+  }
+  
+  uint8_t job;
+  int reason = adcStartCollection(channels, numChannels, args->value[1], args->value[2], &job);
+  return adcReportStart(reason, job);
+}
 
-  return CMD_SUCCESS;
+/*
+===================================================================================================
+  COMMAND HELPER :: parseChannelList
+  
+   - parses a comma separated list of up to ADC_SCAN_MAX channel numbers, like "0,1,1,5"
+   - return the number of channels, 0 (after printing why) if the list is bad
+===================================================================================================
+*/
+static int parseChannelList(const char* text, uint8_t* channels){
+  int numChannels = 0;
+  while (*text != 0){
+    int channel = 0;
+    int digits = 0;
+    while (*text >= '0' && *text <= '9'){
+      channel = channel*10 + (*text++ - '0');
+      digits++;
+    }
+    if (digits == 0 || digits > 2 || channel > 11 || numChannels == ADC_SCAN_MAX || (*text != ',' && *text != 0)){
+      printf("ERROR: Channels must be a list of up to %d channels 0-11, e.g. 0,1,1,5!\n\n", ADC_SCAN_MAX);
+      return 0;
+    }
+    channels[numChannels++] = channel;
+    if (*text == ','){
+      text++;
+    }
+  }
+  return numChannels;
 }
 
 /*
 ===================================================================================================
-  COMMAND HANDLER :: ledTogglerHandler
+  COMMAND HANDLER :: adcStreamHandler
   
-   - enables the periodic led toggler task 
+   - streams a channel list through uDMA ping-pong blocks until killed, every block goes through
+     adcStreamConsumer
    - return success value
 ===================================================================================================
 */
-int ledTogglerHandler(char** tokens, uint8_t numTokens){
-  if (ledTogglerEnabled){
-    printf("ERROR: Toggler already running!\n\n");
+int adcStreamHandler(CmdArgs* args){
+  uint8_t channels[ADC_SCAN_MAX];
+  int numChannels = parseChannelList(args->arg[0], channels);
+  int frequency = args->value[1];
+  if (numChannels == 0){
     return CMD_FAILURE;
   }
-    
-	// verify correct number of arguments
-  if (numTokens < 3) {
-    printf("ERROR: Incorrect number of args.\n\n");
-    printf("  Usage: ledToggler [period in ms]\n\n");
+  if ((numChannels & (numChannels - 1)) != 0 ||
+      ((uint32_t)frequency * numChannels) << PARAM_Get(PARAM_ADC_HW_AVERAGE) > ADC_MAX_CONVERSIONS){
+    printf("ERROR: Stream 1, 2, 4 or 8 channels, at most %d conversions/s in total (hardware averaging included)!\n\n",
+           ADC_MAX_CONVERSIONS);
     return CMD_FAILURE;
   }
-
-	// parse arguments to integers
-  int period = atoi(tokens[2]);
-	
-	// verify argument range
-	if (period < 1 || period > 1000000){
-    printf("ERROR: Period must be positive and less than 1,000,000 ms.\n\n");
+  if (numChannels > 1 && FILTER_Enabled()){
+    printf("ERROR: The filter runs on one channel, stream one or run filterClear!\n\n");
     return CMD_FAILURE;
   }
-	
-	// actually do what we want
-	OS_AddPeriodicThread(ledTogglerTask, period, 0);
-  printf("  Enabling PF3 toggler with a %dms period...\n\n", period);
-	
-  ledTogglerEnabled = true;
-	return CMD_SUCCESS;
+  if (ADCstatus == ADC_STATUS_BUSY){
+    return adcReportStart(ADC_START_BUSY, 0);
+  }
+  uint8_t job = JOB_Start("adcStream", adcJobPoll, ADC_Stop);
+  if (job == 0){
+    return adcReportStart(ADC_START_JOBS, 0);
+  }
+  
+  captureBits = 0;
+  setCaptureChannels(channels, 0);
+  FILTER_Reset();
+  streamCalibrated = false;
+  for (int i = 0; i < numChannels; i++){
+    streamChannels[i] = channels[i];
+    streamCalibrated |= CALIB_Enabled(channels[i]);
+  }
+  streamChannelCount = numChannels;
+  ADC_StreamStart(channels, numChannels, frequency, adcStreamConsumer);
+  return adcReportStart(ADC_START_OK, job);
 }
 
 /*
 ===================================================================================================
-  COMMAND HANDLER :: ledDisablerHandler
+  COMMAND HANDLER :: adcScanHandler
   
-   - disables the periodic led toggler task 
+   - converts a channel list on every base trigger, each channel averages its own number of
+     base samples into its own stream in the sample buffer (see scan.h)
    - return success value
 ===================================================================================================
 */
-int ledDisablerHandler(char** tokens, uint8_t numTokens){
-	// actually do what we want
-  printf("  Disabling PF3 toggler...\n");
-	PF3 = 0x00;
-  ledTogglerEnabled = false;
-	if (OS_RemovePeriodicThread(ledTogglerTask)){
-      printf("  ERROR: Could not remove task.\n\n");
+int adcScanHandler(CmdArgs* args){
+  SCAN_Entry list[ADC_SCAN_MAX];
+  int numChannels = parseScanList(args->arg[0], list);
+  uint32_t frequency = args->value[1];
+  uint32_t triggers = args->value[2];
+  if (numChannels == 0){
+    return CMD_FAILURE;
+  }
+  
+  // every trigger is one interrupt however long the list, the conversions add up
+  if ((frequency * numChannels) << PARAM_Get(PARAM_ADC_HW_AVERAGE) > ADC_MAX_CONVERSIONS){
+    return adcReportStart(ADC_START_FREQUENCY, 0);
+  }
+  uint32_t size = SCAN_Size(list, numChannels, triggers);
+  if (size > ADC_MAX_SAMPLES){
+    printf("ERROR: Scan needs %u samples, the buffer holds %d!\n\n", size, ADC_MAX_SAMPLES);
+    return CMD_FAILURE;
+  }
+  for (int i = 0; i < numChannels; i++){
+    if (triggers / list[i].decimation == 0){
+      printf("ERROR: Channel %d decimates by more than the number of triggers!\n\n", list[i].channel);
       return CMD_FAILURE;
+    }
   }
-  printf("\n");
-	return CMD_SUCCESS;
+  if (ADCstatus == ADC_STATUS_BUSY){
+    return adcReportStart(ADC_START_BUSY, 0);
+  }
+  uint8_t job = JOB_Start("adcScan", adcJobPoll, ADC_Stop);
+  if (job == 0){
+    return adcReportStart(ADC_START_JOBS, 0);
+  }
+  
+  captureBits = 0;
+  setCaptureChannels(NULL, 0);
+  SCAN_Start(list, numChannels, frequency, triggers, adcBuffer);
+  return adcReportStart(ADC_START_OK, job);
 }
 
 /*
 ===================================================================================================
-  COMMAND TASK ::  ledTogglerTask
+  COMMAND HELPER :: parseScanList
   
-   - toggles PF3 (usually called as a periodic task)
+   - parses a comma separated list of up to ADC_SCAN_MAX channel:decimation pairs, like
+     "0:1,3:10", a channel without a decimation keeps every sample
+   - return the number of channels, 0 (after printing why) if the list is bad
 ===================================================================================================
 */
-void ledTogglerTask(void){
-	debug_ledToggle(PF3);		// toggle green led
+static int parseScanList(const char* text, SCAN_Entry* list){
+  int numChannels = 0;
+  while (*text != 0){
+    uint32_t channel = 0;
+    uint32_t decimation = 1;
+    int digits = 0;
+    while (*text >= '0' && *text <= '9' && digits < 3){
+      channel = channel*10 + (*text++ - '0');
+      digits++;
+    }
+    bool good = (digits > 0 && digits <= 2 && channel <= 11 && numChannels < ADC_SCAN_MAX);
+    if (good && *text == ':'){
+      text++;
+      decimation = 0;
+      digits = 0;
+      while (*text >= '0' && *text <= '9' && digits < 6){
+        decimation = decimation*10 + (*text++ - '0');
+        digits++;
+      }
+      good = (digits > 0 && decimation >= 1 && decimation <= 65535);
+    }
+    if (!good || (*text != ',' && *text != 0)){
+      printf("ERROR: Channels must be a list of up to %d channel:decimation pairs, e.g. 0:1,3:10!\n\n", ADC_SCAN_MAX);
+      return 0;
+    }
+    list[numChannels].channel = channel;
+    list[numChannels].decimation = decimation;
+    numChannels++;
+    if (*text == ','){
+      text++;
+    }
+  }
+  return numChannels;
 }
 
 /*
 ===================================================================================================
-  COMMAND HANDLER :: helloTopScreenHandler
+  COMMAND HANDLER :: adcDualHandler
   
-   - test print for upper screen
+   - samples two channels on the same trigger with ADC0 and ADC1, stored as pairs
    - return success value
 ===================================================================================================
 */
-int helloTopScreenHandler(char** tokens, uint8_t numTokens){
-  printf("  Writing something to the top screen...\n\n");
-  ST7735_Message(0, 0, "Hello top screen!", 42);
-  return CMD_SUCCESS;
+int adcDualHandler(CmdArgs* args){
+  // arguments were range checked against adcDualArgs
+  if ((uint32_t)args->value[2] << PARAM_Get(PARAM_ADC_HW_AVERAGE) > ADC_MAX_CONVERSIONS){
+    return adcReportStart(ADC_START_FREQUENCY, 0);
+  }
+  if (COMPARE_Armed()){
+    printf("ERROR: ADC1 is running comparator watches, run adcUnwatch first!\n\n");
+    return CMD_FAILURE;
+  }
+  if (ADCstatus == ADC_STATUS_BUSY){
+    return adcReportStart(ADC_START_BUSY, 0);
+  }
+  uint8_t job = JOB_Start("adcDual", adcJobPoll, ADC_Stop);
+  if (job == 0){
+    return adcReportStart(ADC_START_JOBS, 0);
+  }
+  
+  captureBits = 0;
+  uint8_t pair[2] = { args->value[0], args->value[1] };
+  setCaptureChannels(pair, 2);
+  ADC_CollectDual(args->value[0], args->value[1], args->value[4], args->value[2], adcBuffer, args->value[3]);
+  return adcReportStart(ADC_START_OK, job);
 }
 
 /*
 ===================================================================================================
-  COMMAND HANDLER :: helloBottomScreenHandler
+  COMMAND HANDLER :: scopeHandler
   
-   - test print for bottom screen
+   - streams one channel into the sample buffer as a ring until the trigger, keeping pre
+     samples before it and post from it on
    - return success value
 ===================================================================================================
 */
-int helloBottomScreenHandler(char** tokens, uint8_t numTokens){
-  printf("  Writing something to the bottom screen...\n\n");
-  ST7735_Message(1, 0, "Hello bottom screen!", 42);
-  return CMD_SUCCESS;
-} 
+int scopeHandler(CmdArgs* args){
+  SCOPE_Trigger trigger;
+  trigger.level = args->value[2];
+  trigger.pre = args->value[4];
+  trigger.post = args->value[5];
+  
+  if (strcmp(args->arg[3], "rising") == 0){
+    trigger.slope = SCOPE_RISING;
+  } else if (strcmp(args->arg[3], "falling") == 0){
+    trigger.slope = SCOPE_FALLING;
+  } else if (strcmp(args->arg[3], "either") == 0){
+    trigger.slope = SCOPE_EITHER;
+  } else {
+    printf("ERROR: Slope must be rising, falling or either!\n\n");
+    return CMD_FAILURE;
+  }
+  if (trigger.pre + trigger.post > ADC_MAX_SAMPLES){
+    return adcReportStart(ADC_START_MEMORY, 0);
+  }
+  if ((uint32_t)args->value[1] << PARAM_Get(PARAM_ADC_HW_AVERAGE) > ADC_MAX_CONVERSIONS){
+    return adcReportStart(ADC_START_FREQUENCY, 0);
+  }
+  if (ADCstatus == ADC_STATUS_BUSY){
+    return adcReportStart(ADC_START_BUSY, 0);
+  }
+  uint8_t job = JOB_Start("scope", adcJobPoll, ADC_Stop);
+  if (job == 0){
+    return adcReportStart(ADC_START_JOBS, 0);
+  }
+  
+  uint8_t channel = args->value[0];
+  captureBits = 12;
+  captureRate = args->value[1];
+  setCaptureChannels(&channel, 1);
+  SCOPE_Start(channel, args->value[1], &trigger, adcBuffer);
+  return adcReportStart(ADC_START_OK, job);
+}
 
 /*
 ===================================================================================================
-  COMMAND HELPER :: printHelp
+  COMMAND HELPER :: adcStreamConsumer
   
-   - prints help text of a specified commandArray, with optional indentation
-   - return success value
+   - default streaming block handler, runs in the ADC interrupt, filters the block in place when
+     a filter is set and one channel streams (it may be set after adcStream started) and keeps the last block's header, min, max and mean for get adcStream
+   - with calibration on a streamed channel, converts the block and keeps each channel's mean
+     in its units
 ===================================================================================================
 */
-void printHelp(Command* commandArray, char* indent){
-  int i = 0;
-  // iterate through the command array printing each commands help text
-  while (commandArray[i].function != NULL){
-    printf("%s%s %s\n", indent, commandArray[i].key, commandArray[i].helpText);
-    i++;
+static void adcStreamConsumer(uint16_t* block, uint32_t length, const ADC_BlockHeader* header){
+  streamHeader = *header;
+  if (header->channels == 1 && FILTER_Enabled()){
+    length = FILTER_Block(block, length, 12);
+    if (length == 0){
+      return;
+    }
+  }
+  
+  uint16_t min = 0xFFFF;
+  uint16_t max = 0;
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < length; i++){
+    uint16_t sample = block[i];
+    if (sample < min) min = sample;
+    if (sample > max) max = sample;
+    sum += sample;
+  }
+  streamStats.min = min;
+  streamStats.max = max;
+  streamStats.mean = sum / length;
+  
+  if (streamCalibrated){
+    int32_t sums[ADC_SCAN_MAX] = {0};
+    CALIB_Block(streamChannels, streamChannelCount, block, streamValues, length, 12);
+    for (uint32_t i = 0; i < length; i++){
+      sums[i & (streamChannelCount - 1)] += streamValues[i];   // a power of 2 channels
+    }
+    for (int i = 0; i < streamChannelCount; i++){
+      streamUnits[i] = sums[i] / (int32_t)(length / streamChannelCount);
+    }
   }
-  printf("\n");
 }
 
 /*
 ===================================================================================================
-  COMMAND GETTER :: pwmFreqGetter
+  COMMAND HELPER :: adcReportStart
   
-   - 
+   - prints the outcome of adcStartCollection for the text front end
    - return success value
 ===================================================================================================
 */
-int pwmFreqGetter(char** tokens, uint8_t numTokens){
-  printf("\nPWM0A frequency is: %d Hz\n\n", PWM0A_GetFrequency());
+static int adcReportStart(int reason, uint8_t job){
+  switch (reason){
+    case ADC_START_CHANNEL:
+      printf("ERROR: Channel number out of range!\n\n");
+      return CMD_FAILURE;
+    case ADC_START_FREQUENCY:
+      printf("ERROR: Sample frequency out of range!\n\n");
+      return CMD_FAILURE;
+    case ADC_START_MEMORY:
+      printf("ERROR: Sample buffer holds at most %d samples!\n\n", ADC_MAX_SAMPLES);
+      return CMD_FAILURE;
+    case ADC_START_BUSY:
+      printf("ERROR: ADC busy, wait for or kill its job first!\n\n");
+      return CMD_FAILURE;
+    case ADC_START_JOBS:
+      printf("ERROR: Too many running jobs!\n\n");
+      return CMD_FAILURE;
+  }
+
+  printf("  [%d] %s started\n\n", job, JOB_Find(job)->name);
   return CMD_SUCCESS;
 }
+
+/*
+===================================================================================================
+  COMMAND HELPER :: adcStartCollection
+  
+   - validates collection arguments and starts the adc sampler into the static sample buffer,
+     one channel uses sequencer 3, a list of up to ADC_SCAN_MAX uses sequencers 0 and 1 and stores
+     numSamples per channel, interleaved
+   - registers the capture as a background job, its id goes to *job
+   - shared by the text and binary front ends, so it prints nothing
+   - return ADC_START_OK or the reason it did not start
+===================================================================================================
+*/
+static int adcStartCollection(const uint8_t* channels, int numChannels, int frequency, int numSamples, uint8_t* job){
+  // verify channel range
+  if (numChannels < 1 || numChannels > ADC_SCAN_MAX){
+    return ADC_START_CHANNEL;
+  }
+  for (int i = 0; i < numChannels; i++){
+    if (channels[i] > 11){
+      return ADC_START_CHANNEL;
+    }
+  } 
+  
+  // verify frequency range, decimation multiplies the trigger rate of a single channel and
+  // hardware averaging the conversion rate
+  uint32_t results = (uint32_t)frequency * numChannels;
+  if (numChannels == 1){
+    results <<= PARAM_Get(PARAM_ADC_DECIMATION);
+  }
+  if (frequency < 100 || frequency > 10000 || results > ADC_MAX_INTERRUPTS ||
+      (results << PARAM_Get(PARAM_ADC_HW_AVERAGE)) > ADC_MAX_CONVERSIONS){
+    return ADC_START_FREQUENCY;
+  } 
+
+  if (numSamples < 1 || numSamples * numChannels > ADC_MAX_SAMPLES){
+    return ADC_START_MEMORY;
+  } 
+  
+  // a running capture owns the buffer and the sequencer
+  if (ADCstatus == ADC_STATUS_BUSY){
+    return ADC_START_BUSY;
+  }
+  *job = JOB_Start((numChannels == 1) ? "adcCollect" : "adcMulti", adcJobPoll, ADC_Stop);
+  if (*job == 0){
+    return ADC_START_JOBS;
+  }
+    
+  // start adc collection task
+  setCaptureChannels(channels, numChannels);
+  if (numChannels == 1){
+    captureBits = ADC_SampleBits();
+    captureRate = frequency;
+    ADC_Collect(channels[0], frequency, adcBuffer, numSamples);
+  } else {
+    captureBits = 0;
+    ADC_CollectMulti(channels, numChannels, frequency, adcBuffer, numSamples * numChannels);
+  }
+
+  return ADC_START_OK;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: adcJobPoll
+  
+   - job poll function of a capture, done once the last sample is stored
+===================================================================================================
+*/
+static int adcJobPoll(void){
+  return (ADCstatus == ADC_STATUS_BUSY) ? JOB_RUNNING : JOB_DONE;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: ledTogglerHandler
+  
+   - enables the periodic led toggler task as a background job
+   - return success value
+===================================================================================================
+*/
+int ledTogglerHandler(CmdArgs* args){
+  if (ledTogglerEnabled){
+    printf("ERROR: Toggler already running!\n\n");
+    return CMD_FAILURE;
+  }
+    
+	// period was range checked against ledTogglerArgs
+  int period = args->value[0];
+	
+  uint8_t job = ledTogglerStart(period);
+  if (job == 0){
+    printf("ERROR: Too many running jobs!\n\n");
+    return CMD_FAILURE;
+  }
+  printf("  [%d] Enabling PF3 toggler with a %dms period...\n\n", job, period);
+	return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: ledTogglerStart
+  
+   - adds the toggler task and registers it as a job
+   - return the job id, 0 if the job table is full
+===================================================================================================
+*/
+static uint8_t ledTogglerStart(uint32_t period){
+  uint8_t job = JOB_Start("ledToggler", ledTogglerJobPoll, ledTogglerJobKill);
+  if (job == 0){
+    return 0;
+  }
+	
+	// actually do what we want
+	OS_AddPeriodicThread(ledTogglerTask, period, 0);
+  ledTogglerEnabled = true;
+  return job;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: ledTogglerJobPoll / ledTogglerJobKill
+  
+   - job functions of the toggler, it runs until killed or turned off with ledDisabler
+===================================================================================================
+*/
+static int ledTogglerJobPoll(void){
+  return ledTogglerEnabled ? JOB_RUNNING : JOB_DONE;
+}
+static void ledTogglerJobKill(void){
+  ledTogglerEnabled = false;
+  OS_RemovePeriodicThread(ledTogglerTask);
+	PF3 = 0x00;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: pwmEnableApply / pwmFreqApply / pwmDutyApply
+  
+   - parameter apply functions for PWM0A, frequency and duty only touch the hardware once
+     pwmEnable has started it (its registers fault while the PWM clock is off)
+===================================================================================================
+*/
+static void pwmEnableApply(int32_t enable){
+  if (enable && !pwmRunning){
+    PWM0A_Init(40000, 20000);
+    PWM0A_SetFrequency(PARAM_Get(PARAM_PWM_FREQ));
+    PWM0A_SetDutyPercent(PARAM_Get(PARAM_PWM_DUTY));
+    PWM0A_Enable();
+    pwmRunning = true;
+  } else if (!enable && pwmRunning){
+    PWM0A_Disable();
+    pwmRunning = false;
+  }
+}
+static void pwmFreqApply(int32_t frequency){
+  if (pwmRunning){
+    PWM0A_SetFrequency(frequency);
+  }
+}
+static void pwmDutyApply(int32_t duty){
+  if (pwmRunning){
+    PWM0A_SetDutyPercent(duty);
+  }
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: ledPeriodApply
+  
+   - parameter apply function, restarts the toggler with the new period (0 stops it)
+===================================================================================================
+*/
+static void ledPeriodApply(int32_t period){
+  if (ledTogglerEnabled){
+    ledTogglerJobKill();
+  }
+  if (period > 0 && ledTogglerStart(period) == 0){
+    LOG_ERR(CMD, "no job slot for the toggler");
+  }
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: adcAutostartApply
+  
+   - parameter apply function, starts a capture with the stored ADC parameters
+===================================================================================================
+*/
+static void adcAutostartApply(int32_t autostart){
+  uint8_t channel = PARAM_Get(PARAM_ADC_CHANNEL);
+  uint8_t job;
+  if (!autostart || ADCstatus == ADC_STATUS_BUSY){
+    return;
+  }
+  if (adcStartCollection(&channel, 1, PARAM_Get(PARAM_ADC_FREQUENCY),
+                         PARAM_Get(PARAM_ADC_SAMPLES), &job) == ADC_START_OK){
+    printf("  [%d] adcCollect started\n", job);
+  }
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: adcAverageApply
+  
+   - parameter apply function of both averaging parameters, takes effect on the next capture
+===================================================================================================
+*/
+static void adcAverageApply(int32_t unused){
+  ADC_SetAveraging(PARAM_Get(PARAM_ADC_HW_AVERAGE), PARAM_Get(PARAM_ADC_DECIMATION));
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: ledDisablerHandler
+  
+   - disables the periodic led toggler task 
+   - return success value
+===================================================================================================
+*/
+int ledDisablerHandler(CmdArgs* args){
+	// actually do what we want
+  printf("  Disabling PF3 toggler...\n");
+	PF3 = 0x00;
+  ledTogglerEnabled = false;
+	if (OS_RemovePeriodicThread(ledTogglerTask)){
+      printf("  ERROR: Could not remove task.\n\n");
+      return CMD_FAILURE;
+  }
+  printf("\n");
+	return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND TASK ::  ledTogglerTask
+  
+   - toggles PF3 (usually called as a periodic task)
+===================================================================================================
+*/
+void ledTogglerTask(void){
+	debug_ledToggle(PF3);		// toggle green led
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: helloTopScreenHandler
+  
+   - test print for upper screen
+   - return success value
+===================================================================================================
+*/
+int helloTopScreenHandler(CmdArgs* args){
+  printf("  Writing something to the top screen...\n\n");
+  ST7735_Message(0, 0, "Hello top screen!", 42);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: helloBottomScreenHandler
+  
+   - test print for bottom screen
+   - return success value
+===================================================================================================
+*/
+int helloBottomScreenHandler(CmdArgs* args){
+  printf("  Writing something to the bottom screen...\n\n");
+  ST7735_Message(1, 0, "Hello bottom screen!", 42);
+  return CMD_SUCCESS;
+} 
+
+/*
+===================================================================================================
+  COMMAND HELPER :: compareKeys
+  
+   - qsort comparison of two commands by key
+===================================================================================================
+*/
+static int compareKeys(const void* a, const void* b){
+  return strcmp(((const Command*)a)->key, ((const Command*)b)->key);
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: sortTable
+  
+   - sorts a terminated command table by key in place, logging any duplicate keys
+   - returns the number of entries, not counting the terminator
+===================================================================================================
+*/
+static uint16_t sortTable(Command* table){
+  uint16_t length = 0;
+  while (table[length].function != NULL){
+    length++;
+  }
+  qsort(table, length, sizeof(Command), compareKeys);
+  for (int i = 1; i < length; i++){
+    if (strcmp(table[i - 1].key, table[i].key) == 0){
+      LOG_ERR(CMD, "duplicate command %s", table[i].key);
+    }
+  }
+  return length;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: CMD_Init
+  
+   - sorts every command table so CMD_Lookup can binary search them, call once at boot
+===================================================================================================
+*/
+void CMD_Init(void){
+  CMD_MainCount = sortTable(mainCommands);
+  setCount = sortTable(setCommands);
+  getCount = sortTable(getCommands);
+  runCount = sortTable(runCommands);
+  scriptCount = sortTable(scriptCommands);
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: CMD_Lookup
+  
+   - binary searches a table sorted by CMD_Init for a key
+   - returns the matching command, NULL if there is none
+===================================================================================================
+*/
+Command* CMD_Lookup(Command* table, uint16_t length, const char* key){
+  uint16_t low = 0;
+  uint16_t high = length;
+  while (low < high){
+    uint16_t middle = (low + high) / 2;
+    int order = strcmp(key, table[middle].key);
+    if (order == 0){
+      return &table[middle];
+    }
+    if (order < 0){
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return NULL;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: parseNumber
+  
+   - parses a whole token as an ARG_INT, ARG_FIXED or ARG_HEX value in one pass
+   - returns false on any stray character, more than 3 fraction digits, or overflow
+===================================================================================================
+*/
+static bool parseNumber(const char* text, uint8_t type, int32_t* value){
+  uint32_t base = (type == ARG_HEX) ? 16 : 10;
+  uint32_t result = 0;
+  int digits = 0;
+  int fraction = -1;                                // fraction digits seen, -1 before the point
+  bool negative = false;
+
+  if (type == ARG_HEX){
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) text += 2;
+  } else if (*text == '-' || *text == '+'){
+    negative = (*text++ == '-');
+  }
+
+  for (; *text != 0; text++){
+    uint32_t digit;
+    if (*text >= '0' && *text <= '9'){
+      digit = *text - '0';
+    } else if (type == ARG_HEX && *text >= 'a' && *text <= 'f'){
+      digit = *text - 'a' + 10;
+    } else if (type == ARG_HEX && *text >= 'A' && *text <= 'F'){
+      digit = *text - 'A' + 10;
+    } else if (type == ARG_FIXED && *text == '.' && fraction < 0){
+      fraction = 0;
+      continue;
+    } else {
+      return false;
+    }
+    if (fraction >= 0 && ++fraction > 3){
+      return false;
+    }
+    if (result > (0x7FFFFFFF - digit) / base){
+      return false;
+    }
+    result = result * base + digit;
+    digits++;
+  }
+  if (digits == 0){
+    return false;
+  }
+
+  // scale fixed point to thousandths
+  if (type == ARG_FIXED){
+    for (fraction = (fraction < 0) ? 0 : fraction; fraction < 3; fraction++){
+      if (result > 0x7FFFFFFF / 10){
+        return false;
+      }
+      result *= 10;
+    }
+  }
+  *value = negative ? -(int32_t)result : (int32_t)result;
+  return true;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: printArgValue
+  
+   - prints a value the way its argument type is typed in
+===================================================================================================
+*/
+static void printArgValue(uint8_t type, int32_t value){
+  if (type == ARG_HEX){
+    printf("0x%X", value);
+  } else if (type == ARG_FIXED){
+    uint32_t magnitude = (value < 0) ? -value : value;
+    printf("%s%u.%03u", (value < 0) ? "-" : "", magnitude / ARG_FIXED_SCALE, magnitude % ARG_FIXED_SCALE);
+  } else {
+    printf("%d", value);
+  }
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: printArgs
+  
+   - prints a command's argument schema as " [name, min-max units]" fields
+===================================================================================================
+*/
+static void printArgs(const ArgSpec* spec){
+  for (; spec->type != ARG_END; spec++){
+    printf(" [%s", spec->name);
+    if (spec->type == ARG_WORD){
+      if (spec->units[0] != 0) printf(": %s", spec->units);
+    } else {
+      printf(", ");
+      printArgValue(spec->type, spec->min);
+      printf("-");
+      printArgValue(spec->type, spec->max);
+      if (spec->units[0] != 0) printf(" %s", spec->units);
+    }
+    printf("]");
+  }
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: printUsage
+  
+   - prints the usage line of a command generated from its keys and schema
+===================================================================================================
+*/
+static void printUsage(Command* command, char** tokens, uint8_t depth){
+  printf("  Usage:");
+  for (int i = 0; i < depth; i++){
+    printf(" %s", tokens[i]);
+  }
+  printArgs(command->args);
+  printf("\n\n");
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: CMD_Execute
+  
+   - parses and range checks the arguments a command declares, printing the error and usage
+     text on failure, then calls its handler with them
+   - extra tokens past the schema are left in args for the handler
+   - return success value
+===================================================================================================
+*/
+int CMD_Execute(Command* command, char** tokens, uint8_t numTokens, uint8_t depth){
+  CmdArgs args;
+  args.tokens = tokens;
+  args.numTokens = numTokens;
+  args.arg = &tokens[depth];
+  args.count = numTokens - depth;
+
+  if (command->args != NULL){
+    for (int i = 0; command->args[i].type != ARG_END; i++){
+      const ArgSpec* spec = &command->args[i];
+      args.value[i] = 0;
+      if (i >= args.count){
+        printf("ERROR: Incorrect number of args.\n\n");
+        printUsage(command, tokens, depth);
+        return CMD_FAILURE;
+      }
+      if (spec->type == ARG_WORD){
+        continue;
+      }
+      if (!parseNumber(args.arg[i], spec->type, &args.value[i])){
+        printf("ERROR: %s is not a valid %s.\n\n", args.arg[i], spec->name);
+        printUsage(command, tokens, depth);
+        return CMD_FAILURE;
+      }
+      if (args.value[i] < spec->min || args.value[i] > spec->max){
+        printf("ERROR: %s must be between ", spec->name);
+        printArgValue(spec->type, spec->min);
+        printf(" and ");
+        printArgValue(spec->type, spec->max);
+        printf(".\n\n");
+        return CMD_FAILURE;
+      }
+    }
+  }
+  return command->function(&args);
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: printHelp
+  
+   - prints help text of a specified commandArray, with optional indentation
+   - return success value
+===================================================================================================
+*/
+void printHelp(Command* commandArray, char* indent){
+  int i = 0;
+  // iterate through the command array printing each commands help text
+  while (commandArray[i].function != NULL){
+    printf("%s%s", indent, commandArray[i].key);
+    if (commandArray[i].args != NULL){
+      printArgs(commandArray[i].args);
+    }
+    printf(" %s\n", commandArray[i].helpText);
+    i++;
+  }
+  printf("\n");
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: pwmFreqGetter
+  
+   - 
+   - return success value
+===================================================================================================
+*/
+int pwmFreqGetter(CmdArgs* args){
+  printf("\nPWM0A frequency is: %d Hz\n\n", PWM0A_GetFrequency());
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: logLevelSetter
+  
+   - sets the runtime log level of one module, or of all of them
+   - return success value
+===================================================================================================
+*/
+int logLevelSetter(CmdArgs* args){
+  int level = LOG_ParseLevel(args->arg[1]);
+  if (level < 0){
+    printf("ERROR: Unknown log level.\n\n");
+    return CMD_FAILURE;
+  }
+  
+  if (strcmp(args->arg[0], "all") == 0){
+    for (int i = 0; i < LOG_MOD_COUNT; i++){
+      LOG_Levels[i] = level;
+    }
+  } else {
+    LOG_Module module = LOG_FindModule(args->arg[0]);
+    if (module == LOG_MOD_COUNT){
+      printf("ERROR: Unknown log module.\n\n");
+      return CMD_FAILURE;
+    }
+    LOG_Levels[module] = level;
+  }
+  printf("  Setting %s log level to %s...\n\n", args->arg[0], LOG_LevelNames[level]);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: logLevelGetter
+  
+   - lists the runtime log level of every module
+   - return success value
+===================================================================================================
+*/
+int logLevelGetter(CmdArgs* args){
+  printf("\n");
+  for (int i = 0; i < LOG_MOD_COUNT; i++){
+    printf("  %-6s %s\n", LOG_ModuleNames[i], LOG_LevelNames[LOG_Levels[i]]);
+  }
+  printf("  (compiled up to %s)\n\n", LOG_LevelNames[LOG_COMPILE_LEVEL]);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: parseFlow
+  
+   - converts a flow control token to its UART_FLOW_* mode, -1 if unknown
+===================================================================================================
+*/
+static int parseFlow(char* token){
+  if (strcmp(token, "none") == 0) return UART_FLOW_NONE;
+  if (strcmp(token, "xonxoff") == 0) return UART_FLOW_XONXOFF;
+  if (strcmp(token, "rtscts") == 0) return UART_FLOW_RTSCTS;
+  return -1;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: flowControlSetter
+  
+   - selects software flow control on an open UART
+   - return success value
+===================================================================================================
+*/
+int flowControlSetter(CmdArgs* args){
+  UART_Port* port = &UART_Ports[args->value[0]];
+  if (!port->open){
+    printf("ERROR: UART%d is not open.\n\n", port->number);
+    return CMD_FAILURE;
+  }
+  int flow = parseFlow(args->arg[1]);
+  if (flow < 0 || UART_SetFlowControl(port, flow) != CMD_SUCCESS){
+    printf("ERROR: Flow control must be none or xonxoff (rtscts is chosen with uartOpen).\n\n");
+    return CMD_FAILURE;
+  }
+  printf("  Setting UART%d flow control to %s...\n\n", port->number, args->arg[1]);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: telemetryPortSetter
+  
+   - moves unsolicited binary frames (FRAME_Send) to another open UART
+   - return success value
+===================================================================================================
+*/
+int telemetryPortSetter(CmdArgs* args){
+  UART_Port* port = &UART_Ports[args->value[0]];
+  if (!port->open){
+    printf("ERROR: UART%d is not open.\n\n", port->number);
+    return CMD_FAILURE;
+  }
+  FRAME_TelemetryPort = port;
+  printf("  Sending telemetry on UART%d...\n\n", port->number);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: paramSetter
+  
+   - sets and applies a stored parameter, it is lost on reset unless saved with paramSave
+   - return success value
+===================================================================================================
+*/
+int paramSetter(CmdArgs* args){
+  int id = PARAM_Find(args->arg[0]);
+  if (id < 0){
+    printf("ERROR: No parameter named %s, see get params.\n\n", args->arg[0]);
+    return CMD_FAILURE;
+  }
+  const Param* param = &PARAM_Table[id];
+  if (PARAM_Set(id, args->value[1]) != CMD_SUCCESS){
+    printf("ERROR: %s must be %d to %d.\n\n", param->name, param->min, param->max);
+    return CMD_FAILURE;
+  }
+  printf("  %s = %d\n\n", param->name, PARAM_Get(id));
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: adcAverageSetter
+  
+   - sets the hardware oversampling and adcCollect decimation ratios (stored parameters)
+   - return success value
+===================================================================================================
+*/
+int adcAverageSetter(CmdArgs* args){
+  int hardware = args->value[0];
+  int decimation = args->value[1];
+  int hardwareLog2 = 0;
+  int decimationLog2 = 0;
+  
+  // ratios were range checked against adcAverageArgs, they must also be powers of 2
+  if ((hardware & (hardware - 1)) != 0 || (decimation & (decimation - 1)) != 0){
+    printf("ERROR: Ratios must be powers of 2!\n\n");
+    return CMD_FAILURE;
+  }
+  while ((1 << hardwareLog2) < hardware) hardwareLog2++;
+  while ((1 << decimationLog2) < decimation) decimationLog2++;
+  
+  PARAM_Set(PARAM_ADC_HW_AVERAGE, hardwareLog2);
+  PARAM_Set(PARAM_ADC_DECIMATION, decimationLog2);
+  printf("  Averaging %dx in hardware, %dx decimation, adcCollect samples are %u bits...\n\n",
+         hardware, decimation, ADC_SampleBits());
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: printUartErrors
+  
+   - prints one UART's error counters on a line
+===================================================================================================
+*/
+static void printUartErrors(UART_Port* port){
+  UART_ErrorCounts* errors = &port->errors;
+  printf("  UART%d: overrun %u, framing %u, parity %u, break %u, dropped %u, xoff %u\n", port->number,
+         errors->overrun, errors->framing, errors->parity, errors->breaks, errors->dropped, errors->xoffSent);
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: uartStatsGetter
+  
+   - prints receive error and drop counters of every open UART
+   - return success value
+===================================================================================================
+*/
+int uartStatsGetter(CmdArgs* args){
+  printf("\n");
+  for (int i = 0; i < UART_NUM_PORTS; i++){
+    if (UART_Ports[i].open){
+      printUartErrors(&UART_Ports[i]);
+    }
+  }
+  printf("  shell UART%d: dropped frames %u, bad frames %u, telemetry on UART%d\n", USB_UART_Port->number,
+         USB_DroppedFrames, FRAME_BadFrames, FRAME_TelemetryPort->number);
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: paramsGetter
+  
+   - lists every stored parameter with its range, * marks values not saved to EEPROM yet
+   - return success value
+===================================================================================================
+*/
+int paramsGetter(CmdArgs* args){
+  printf("\n");
+  for (int i = 0; i < PARAM_COUNT; i++){
+    const Param* param = &PARAM_Table[i];
+    printf("  %-12s %8d%c (%d-%d, default %d)\n", param->name, PARAM_Get(i),
+           PARAM_Unsaved(i) ? '*' : ' ', param->min, param->max, param->defaultValue);
+  }
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: adcStreamGetter
+  
+   - prints streaming progress and the last block's statistics
+   - return success value
+===================================================================================================
+*/
+int adcStreamGetter(CmdArgs* args){
+  printf("\n  blocks %u (%u samples), overruns %u\n", ADCstreamBlocks, ADCstreamBlocks * ADC_STREAM_BLOCK,
+         ADCstreamOverruns);
+  printf("  last block: min %u, max %u, mean %u\n", streamStats.min, streamStats.max, streamStats.mean);
+  if (ADCstreamBlocks > 0){
+    long sr = StartCritical();       // the ADC interrupt rewrites it every block
+    ADC_BlockHeader header = streamHeader;
+    EndCritical(sr);
+    printf("  block %u started at %u ms (cycle %u)", header.sequence, header.startMs, header.startCycles);
+    printHeaderFlags(header.flags);
+  }
+  if (streamCalibrated && ADCstreamBlocks > 0){
+    for (int i = 0; i < streamChannelCount; i++){
+      printf("  channel %u mean %d %s\n", streamChannels[i], streamUnits[i], CALIB_Units(streamChannels[i]));
+    }
+  }
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: adcInfoGetter
+  
+   - prints the last capture's header: when it started, the exact trigger period and the rate
+     the samples really have, which differs from the requested one by the timer's rounding
+   - return success value
+===================================================================================================
+*/
+int adcInfoGetter(CmdArgs* args){
+  long sr = StartCritical();
+  ADC_BlockHeader header = ADCheader;
+  EndCritical(sr);
+  if (header.periodCycles == 0){
+    printf("ERROR: Nothing captured yet!\n\n");
+    return CMD_FAILURE;
+  }
+  
+  printf("\n  channel %u", header.channel);
+  if (header.channels > 1){
+    printf(" (+%u more)", header.channels - 1);
+  }
+  printf(", %u samples of %u bits%s\n", header.samples, header.bits, (ADCstatus == ADC_STATUS_BUSY) ? " so far" : "");
+  printf("  started at %u ms (cycle %u)\n", header.startMs, header.startCycles);
+  printf("  trigger every %u cycles, sample every %u cycles\n", header.periodCycles, header.sampleCycles);
+  printf("  rate %u.%03u Hz, requested %u Hz", header.rateMilliHz / 1000, header.rateMilliHz % 1000, header.requestedHz);
+  printHeaderFlags(header.flags);
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: scopeGetter
+  
+   - prints what the scope is doing, once done the window is the last capture (FRAME_SAMPLES)
+   - return success value
+===================================================================================================
+*/
+int scopeGetter(CmdArgs* args){
+  static const char* const states[] = { "idle", "filling", "armed", "triggered", "done" };
+  uint8_t state = SCOPE_State;
+  bool stopped = (state != SCOPE_DONE && state != SCOPE_IDLE && ADCstatus != ADC_STATUS_BUSY);
+  
+  printf("\n  %s, %u samples seen\n", stopped ? "killed" : states[state], SCOPE_Seen);
+  if (state >= SCOPE_TRIGGERED){
+    printf("  triggered at sample %u\n", SCOPE_TriggerSample);
+  }
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: adcScanGetter
+  
+   - lists every channel of the last adcScan with its rate and where its stream starts in the
+     sample buffer (FRAME_SAMPLES offset)
+   - return success value
+===================================================================================================
+*/
+int adcScanGetter(CmdArgs* args){
+  if (SCAN_Count == 0){
+    printf("  no scan yet\n\n");
+    return CMD_SUCCESS;
+  }
+  printf("\n  channel  decimation  rate(Hz)  samples  offset\n");
+  for (int i = 0; i < SCAN_Count; i++){
+    SCAN_Stream* stream = &SCAN_Streams[i];
+    printf("  %7d  %10d  %8u  %7u  %6d\n", stream->entry.channel, stream->entry.decimation,
+           SCAN_Frequency / stream->entry.decimation, stream->count, (int)(stream->data - adcBuffer));
+  }
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: uartOpenHandler
+  
+   - opens a UART for streaming, optionally with flow control
+   - return success value
+===================================================================================================
+*/
+int uartOpenHandler(CmdArgs* args){
+  UART_Port* port = &UART_Ports[args->value[0]];
+  if (port == USB_UART_Port){
+    printf("ERROR: UART%d is the shell.\n\n", port->number);
+    return CMD_FAILURE;
+  }
+  
+  int baud = args->value[1];
+  int flow = parseFlow(args->arg[2]);
+  if (flow < 0 || UART_Open(port, baud, flow) != CMD_SUCCESS){
+    printf("ERROR: Flow control %s not available on UART%d, or its pins belong to an open UART!\n\n",
+           args->arg[2], port->number);
+    return CMD_FAILURE;
+  }
+  printf("  Opening UART%d at %d baud, flow control %s...\n\n", port->number, baud, args->arg[2]);
+  return CMD_SUCCESS;
+}
+  
+/*
+===================================================================================================
+  COMMAND HANDLER :: uartSendHandler
+  
+   - prints the remaining tokens as a line on another UART through its printf stream
+   - return success value
+===================================================================================================
+*/
+int uartSendHandler(CmdArgs* args){
+  UART_Port* port = &UART_Ports[args->value[0]];
+  if (!port->open){
+    printf("ERROR: UART%d is not open.\n\n", port->number);
+    return CMD_FAILURE;
+  }
+  FILE* stream = UART_Stream(port);
+  for (int i = 1; i < args->count; i++){
+    fprintf(stream, (i + 1 < args->count) ? "%s " : "%s\r\n", args->arg[i]);
+  }
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: paramSaveHandler
+  
+   - writes the parameters that changed to EEPROM
+   - return success value
+===================================================================================================
+*/
+int paramSaveHandler(CmdArgs* args){
+  if (PARAM_Save() != CMD_SUCCESS){
+    printf("ERROR: EEPROM write failed!\n\n");
+    return CMD_FAILURE;
+  }
+  printf("  Parameters saved.\n\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: paramLoadHandler
+  
+   - drops unsaved changes, reloading and applying the parameters in EEPROM
+   - return success value
+===================================================================================================
+*/
+int paramLoadHandler(CmdArgs* args){
+  int status = PARAM_Load();
+  PARAM_ApplyAll();
+  if (status != CMD_SUCCESS){
+    printf("ERROR: No parameters stored, using defaults.\n\n");
+    return CMD_FAILURE;
+  }
+  printf("  Parameters loaded.\n\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: paramDefaultsHandler
+  
+   - applies the default parameters without saving them
+   - return success value
+===================================================================================================
+*/
+int paramDefaultsHandler(CmdArgs* args){
+  PARAM_Defaults();
+  printf("  Defaults applied, run paramSave to keep them.\n\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: adcStatsSetter
+  
+   - sets the statistics block length and zero crossing band, the statistics start over
+   - return success value
+===================================================================================================
+*/
+int adcStatsSetter(CmdArgs* args){
+  STATS_Configure(args->value[0], args->value[1], args->value[2]);
+  printf("  Statistics over %u sample blocks, crossings of %u +/- %u...\n\n", STATS_BlockLength,
+         STATS_Level, STATS_Hysteresis);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: printStats
+  
+   - prints one statistics summary on a line
+===================================================================================================
+*/
+static void printStats(const char* name, int which){
+  STATS_Summary summary;
+  if (!STATS_Get(which, &summary)){
+    printf("  %-6s no samples\n", name);
+    return;
+  }
+  printf("  %-6s %7u %5u %5u %5u %5u %5u %5u %6u\n", name, summary.count, summary.min, summary.max,
+         summary.peakToPeak, summary.mean, summary.rms, summary.deviation, summary.crossings);
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: adcStatsGetter
+  
+   - prints the statistics the ADC interrupts kept for the last adcCollect or one channel
+     adcStream, in codes
+   - return success value
+===================================================================================================
+*/
+int adcStatsGetter(CmdArgs* args){
+  printf("\n  %u blocks of %u samples, crossings of %u +/- %u\n", STATS_Blocks, STATS_BlockLength,
+         STATS_Level, STATS_Hysteresis);
+  printf("         samples   min   max   p-p  mean   rms    ac  cross\n");
+  printStats("block", STATS_LAST);
+  printStats("total", STATS_TOTAL);
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: filterTapsSetter
+  
+   - parses a comma separated list of Q15 taps and writes them from tap first on, long filters
+     take several lines
+   - return success value
+===================================================================================================
+*/
+int filterTapsSetter(CmdArgs* args){
+  int16_t taps[FILTER_MAX_TAPS];
+  int count = parseValueList(args->arg[1], taps, FILTER_MAX_TAPS);
+  if (count < 0){
+    printf("ERROR: Taps must be a list of Q15 values -32768 to 32767, e.g. 8192,16384,8192!\n\n");
+    return CMD_FAILURE;
+  }
+  
+  if (count == 0 || FILTER_SetTaps(args->value[0], taps, count) != CMD_SUCCESS){
+    printf("ERROR: First must be at most %d and the filter at most %d taps!\n\n",
+           FILTER_Settings.numTaps, FILTER_MAX_TAPS);
+    return CMD_FAILURE;
+  }
+  printf("  FIR has %d taps...\n\n", FILTER_Settings.numTaps);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: filterBiquadSetter
+  
+   - sets a biquad stage from coefficients in thousandths, stored as Q2.14
+   - return success value
+===================================================================================================
+*/
+int filterBiquadSetter(CmdArgs* args){
+  int16_t q[5];
+  
+  // arguments were range checked against filterBiquadArgs, |value| < 2 fits in Q2.14
+  for (int i = 0; i < 5; i++){
+    int32_t value = args->value[i + 1] * FILTER_BIQUAD_ONE;
+    q[i] = (value + ((value < 0) ? -ARG_FIXED_SCALE/2 : ARG_FIXED_SCALE/2)) / ARG_FIXED_SCALE;
+  }
+  FILTER_Biquad biquad = { q[0], q[1], q[2], q[3], q[4] };
+  if (FILTER_SetBiquad(args->value[0], &biquad) != CMD_SUCCESS){
+    printf("ERROR: Stage must be at most %d!\n\n", FILTER_Settings.numBiquads);
+    return CMD_FAILURE;
+  }
+  printf("  %d biquad stages...\n\n", FILTER_Settings.numBiquads);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: filterAverageSetter
+  
+   - sets the moving average length
+   - return success value
+===================================================================================================
+*/
+int filterAverageSetter(CmdArgs* args){
+  FILTER_SetAverage(args->value[0]);
+  printf("  Moving average of %d samples...\n\n", FILTER_Settings.average);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: filterDecimateSetter
+  
+   - sets how many filtered samples go into each kept one
+   - return success value
+===================================================================================================
+*/
+int filterDecimateSetter(CmdArgs* args){
+  FILTER_SetDecimate(args->value[0]);
+  printf("  Keeping 1 of every %d samples...\n\n", FILTER_Settings.decimate);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: filterGetter
+  
+   - lists every filter stage in the order samples go through them
+   - return success value
+===================================================================================================
+*/
+int filterGetter(CmdArgs* args){
+  printf("\n  moving average %d, decimate %d\n", FILTER_Settings.average, FILTER_Settings.decimate);
+  printf("  FIR %d taps:", FILTER_Settings.numTaps);
+  for (int i = 0; i < FILTER_Settings.numTaps; i++){
+    printf("%s%d", (i % 8 == 0) ? "\n    " : " ", FILTER_Settings.taps[i]);
+  }
+  printf("\n  %d biquads (Q2.14 b0 b1 b2 a1 a2):\n", FILTER_Settings.numBiquads);
+  for (int i = 0; i < FILTER_Settings.numBiquads; i++){
+    const FILTER_Biquad* b = &FILTER_Settings.biquads[i];
+    printf("    %d: %d %d %d %d %d\n", i, b->b0, b->b1, b->b2, b->a1, b->a2);
+  }
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: filterClearHandler
+  
+   - turns every filter stage into a pass-through
+   - return success value
+===================================================================================================
+*/
+int filterClearHandler(CmdArgs* args){
+  FILTER_Clear();
+  printf("  Filter off.\n\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: filterCaptureHandler
+  
+   - filters the last capture in place as one signal, decimation shortens it
+   - return success value
+===================================================================================================
+*/
+int filterCaptureHandler(CmdArgs* args){
+  if (ADCstatus != ADC_STATUS_DONE || captureBits == 0){
+    printf("ERROR: Needs a finished adcCollect or scope capture!\n\n");
+    return CMD_FAILURE;
+  }
+  FILTER_Reset();
+  ADCsamplesMax = FILTER_Block(ADCBufferPointer, ADCsamplesMax, captureBits);
+  ADCsamples = ADCsamplesMax;
+  captureRate /= FILTER_Settings.decimate;
+  ADCheader.samples = ADCsamplesMax;                // the header describes what FRAME_SAMPLES serves
+  ADCheader.sampleCycles *= FILTER_Settings.decimate;
+  ADCheader.rateMilliHz = (uint32_t)((uint64_t)ADC_BUS_HZ*1000/ADCheader.sampleCycles);
+  printf("  %u filtered samples.\n\n", ADCsamplesMax);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: parseValueList
+  
+   - parses a comma separated list of up to max 16-bit signed values, splitting text in place
+   - return the number of values, -1 if the list is bad
+===================================================================================================
+*/
+static int parseValueList(char* text, int16_t* values, int max){
+  int count = 0;
+  while (*text != 0){
+    char* end = text;
+    while (*end != ',' && *end != 0) end++;
+    bool last = (*end == 0);
+    *end = 0;                             // the token is ours, split it in place
+    
+    int32_t value;
+    if (count == max || !parseNumber(text, ARG_INT, &value) || value < -32768 || value > 32767){
+      return -1;
+    }
+    values[count++] = value;
+    text = last ? end : end + 1;
+  }
+  return count;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: setCaptureChannels
+  
+   - records the channel list of the capture being started, 0 channels if it isn't interleaved
+===================================================================================================
+*/
+static void setCaptureChannels(const uint8_t* channels, int numChannels){
+  for (int i = 0; i < numChannels; i++){
+    captureChannels[i] = channels[i];
+  }
+  captureChannelCount = numChannels;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: adcCalSetter
+  
+   - sets a channel's offset in codes and gain in thousandths, stored as Q2.14
+   - return success value
+===================================================================================================
+*/
+int adcCalSetter(CmdArgs* args){
+  // arguments were range checked against adcCalArgs, gain < 4 fits in Q2.14
+  uint16_t gain = (args->value[2] * CALIB_GAIN_ONE + ARG_FIXED_SCALE/2) / ARG_FIXED_SCALE;
+  CALIB_Set(args->value[0], args->value[1], gain);
+  printf("  Channel %d: (code - %d) x %d/%d...\n\n", args->value[0], args->value[1], gain, CALIB_GAIN_ONE);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: adcLutSetter
+  
+   - selects the table a channel's corrected codes are converted with
+   - return success value
+===================================================================================================
+*/
+int adcLutSetter(CmdArgs* args){
+  for (int table = 0; table < CALIB_LUT_COUNT; table++){
+    if (strcmp(args->arg[1], CALIB_TableNames[table]) == 0){
+      CALIB_SetTable(args->value[0], table);
+      printf("  Channel %d reads in %s...\n\n", args->value[0], CALIB_Units(args->value[0]));
+      return CMD_SUCCESS;
+    }
+  }
+  printf("ERROR: Table must be none, gp2y0a21 or user!\n\n");
+  return CMD_FAILURE;
+}
+
+/*
+===================================================================================================
+  COMMAND SETTER :: adcLutPointsSetter
+  
+   - parses a comma separated list of user table points and writes them from point first on,
+     the whole table takes several lines
+   - return success value
+===================================================================================================
+*/
+int adcLutPointsSetter(CmdArgs* args){
+  int16_t points[CALIB_LUT_POINTS];
+  int count = parseValueList(args->arg[1], points, CALIB_LUT_POINTS);
+  if (count <= 0 || CALIB_SetPoints(args->value[0], points, count) != CMD_SUCCESS){
+    printf("ERROR: Points must be a list of values -32768 to 32767, at most %d from point 0!\n\n",
+           CALIB_LUT_POINTS);
+    return CMD_FAILURE;
+  }
+  printf("  Points %d-%d written...\n\n", args->value[0], args->value[0] + count - 1);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: adcCalGetter
+  
+   - lists the channels that don't read as raw codes, then the user table if one uses it
+   - return success value
+===================================================================================================
+*/
+int adcCalGetter(CmdArgs* args){
+  bool user = false;
+  printf("\n");
+  for (int i = 0; i < CALIB_CHANNELS; i++){
+    const CALIB_Channel* cal = &CALIB_Channels[i];
+    if (CALIB_Enabled(i)){
+      printf("  channel %2d: offset %d, gain %d/%d, table %s (%s)\n", i, cal->offset, cal->gain, CALIB_GAIN_ONE,
+             CALIB_TableNames[cal->table], CALIB_Units(i));
+      user |= (cal->table == CALIB_LUT_USER);
+    }
+  }
+  if (user){
+    printf("  user table, every %d codes:\n", 1 << CALIB_LUT_SHIFT);
+    for (int i = 0; i < CALIB_LUT_POINTS; i++){
+      printf("%s%6d", (i % 8 == 0) ? "\n  " : "", CALIB_UserTable[i]);
+    }
+    printf("\n");
+  }
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: calCaptureHandler
+  
+   - converts the last capture to each channel's units in place (signed from then on, see
+     FRAME_SAMPLES) and prints every channel's range and mean
+   - return success value
+===================================================================================================
+*/
+int calCaptureHandler(CmdArgs* args){
+  if (ADCstatus != ADC_STATUS_DONE || captureChannelCount == 0){
+    printf("ERROR: Needs a finished adcCollect, adcMulti, adcDual or scope capture!\n\n");
+    return CMD_FAILURE;
+  }
+  
+  int16_t* values = (int16_t*)ADCBufferPointer;
+  uint8_t count = captureChannelCount;
+  CALIB_Block(captureChannels, count, ADCBufferPointer, values, ADCsamplesMax, ADCheader.bits);
+  
+  printf("\n");
+  for (int k = 0; k < count; k++){
+    int16_t min = 32767;
+    int16_t max = -32768;
+    int32_t sum = 0;
+    uint32_t n = 0;
+    for (uint32_t i = k; i < ADCsamplesMax; i += count){
+      if (values[i] < min) min = values[i];
+      if (values[i] > max) max = values[i];
+      sum += values[i];
+      n++;
+    }
+    if (n > 0){
+      printf("  channel %2d: min %d, max %d, mean %d %s\n", captureChannels[k], min, max, sum / (int32_t)n,
+             CALIB_Units(captureChannels[k]));
+    }
+  }
+  printf("\n");
+  
+  // units now, not codes, filterCapture and fft would read them wrong and a second pass twice
+  captureBits = 0;
+  captureChannelCount = 0;
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: adcWatchHandler
+  
+   - arms a comparator watch on a channel, events print as they happen (see compare.h)
+   - return success value
+===================================================================================================
+*/
+int adcWatchHandler(CmdArgs* args){
+  uint8_t region;
+  if (strcmp(args->arg[2], "above") == 0){
+    region = COMPARE_ABOVE;
+  } else if (strcmp(args->arg[2], "below") == 0){
+    region = COMPARE_BELOW;
+  } else {
+    printf("ERROR: Region must be above or below!\n\n");
+    return CMD_FAILURE;
+  }
+  if (COMPARE_Arm(args->value[0], args->value[1], region, args->value[3], args->value[4]) != CMD_SUCCESS){
+    printf("ERROR: Level and hysteresis must leave room to leave the region (0-4095), and no adcDual may run!\n\n");
+    return CMD_FAILURE;
+  }
+  printf("  Watching channel %d %s %d...\n\n", args->value[1], args->arg[2], args->value[3]);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: adcUnwatchHandler
+  
+   - stops a comparator watch
+   - return success value
+===================================================================================================
+*/
+int adcUnwatchHandler(CmdArgs* args){
+  COMPARE_Disarm(args->value[0]);
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: adcWatchGetter
+  
+   - prints every armed watch, whether its signal is in the region and how often it crossed
+   - return success value
+===================================================================================================
+*/
+int adcWatchGetter(CmdArgs* args){
+  bool any = false;
+  printf("\n");
+  for (int i = 0; i < COMPARE_MAX; i++){
+    const COMPARE_Watch* watch = &COMPARE_Watches[i];
+    if (watch->region == COMPARE_OFF){
+      continue;
+    }
+    printf("  [%d] channel %2d %s %d (hysteresis %d): %s, entered %u, left %u", i, watch->channel,
+           COMPARE_RegionNames[watch->region], watch->level, watch->hysteresis,
+           watch->inside ? "inside" : "outside", watch->enters, watch->leaves);
+    if (watch->enters > 0){
+      printf(", last at %u ms", watch->lastMs);
+    }
+    printf("\n");
+    any = true;
+  }
+  if (!any){
+    printf("  no watches\n");
+  }
+  if (COMPARE_DroppedEvents > 0){
+    printf("  %u events dropped\n", COMPARE_DroppedEvents);
+  }
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: printDecibels
+  
+   - prints a spectrum magnitude as dB below full scale, one decimal
+===================================================================================================
+*/
+static void printDecibels(uint16_t magnitude){
+  int32_t dB = FFT_Decibels(magnitude);
+  printf("%s%d.%d dBFS", (dB < 0) ? "-" : "", abs(dB) / 10, abs(dB) % 10);
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: printHeaderFlags
+  
+   - ends a capture header line with the names of its ADC_FLAG_* flags
+===================================================================================================
+*/
+static void printHeaderFlags(uint8_t flags){
+  if (flags & ADC_FLAG_OVERFLOW) printf(", FIFO overflow");
+  if (flags & ADC_FLAG_GAP) printf(", gap before");
+  if (flags & ADC_FLAG_DROPPED) printf(", lists dropped");
+  if (flags & ADC_FLAG_STOPPED) printf(", stopped early");
+  printf("\n");
+}
+
+/*
+===================================================================================================
+  COMMAND HELPER :: plotSpectrum
+  
+   - draws the last spectrum across the 128 pixel plot, bins sharing a column overlap so the
+     tallest shows, magnitudes scale to the plot's 0-1023
+===================================================================================================
+*/
+static void plotSpectrum(bool decibels){
+  uint16_t* magnitude = (uint16_t*)fftBuffer;
+  uint32_t bins = fftPoints / 2;
+  uint32_t perColumn = (bins > 128) ? bins / 128 : 1;
+  
+  ST7735_PlotClear(0, 1023);
+  for (uint32_t k = 0; k < bins; ){
+    for (uint32_t i = 0; i < perColumn; i++, k++){
+      if (decibels){
+        ST7735_PlotdBfs(magnitude[k] >> 5);
+      } else {
+        ST7735_PlotBar(magnitude[k] >> 5);
+      }
+    }
+    ST7735_PlotNext();
+  }
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: fftHandler
+  
+   - windows the first points samples of the last capture, transforms them and prints the
+     largest peaks, get spectrum lists every bin
+   - return success value
+===================================================================================================
+*/
+int fftHandler(CmdArgs* args){
+  uint32_t points = args->value[0];
+  uint8_t window;
+  int plot;
+  
+  if (strcmp(args->arg[1], "rectangle") == 0){
+    window = FFT_RECTANGLE;
+  } else if (strcmp(args->arg[1], "hann") == 0){
+    window = FFT_HANN;
+  } else if (strcmp(args->arg[1], "hamming") == 0){
+    window = FFT_HAMMING;
+  } else {
+    printf("ERROR: Window must be rectangle, hann or hamming!\n\n");
+    return CMD_FAILURE;
+  }
+  if (strcmp(args->arg[2], "none") == 0){
+    plot = 0;
+  } else if (strcmp(args->arg[2], "bar") == 0){
+    plot = 1;
+  } else if (strcmp(args->arg[2], "dB") == 0){
+    plot = 2;
+  } else {
+    printf("ERROR: Plot must be none, bar or dB!\n\n");
+    return CMD_FAILURE;
+  }
+  if (!FFT_ValidSize(points)){
+    printf("ERROR: Points must be a power of 2!\n\n");
+    return CMD_FAILURE;
+  }
+  if (ADCstatus != ADC_STATUS_DONE || captureBits == 0 || ADCsamplesMax < points){
+    printf("ERROR: Needs a finished adcCollect or scope capture of at least %u samples!\n\n", points);
+    return CMD_FAILURE;
+  }
+  
+  FFT_Load(fftBuffer, ADCBufferPointer, points, captureBits, window);
+  FFT_Real(fftBuffer, points);
+  FFT_Magnitude(fftBuffer, points);
+  fftPoints = points;
+  fftRate = captureRate;
+  
+  // largest local maxima, DC left out
+  uint16_t* magnitude = (uint16_t*)fftBuffer;
+  uint32_t peaks[3] = { 0, 0, 0 };
+  for (uint32_t k = 1; k < points / 2; k++){
+    if (magnitude[k] < magnitude[k - 1] || (k + 1 < points / 2 && magnitude[k] < magnitude[k + 1])){
+      continue;
+    }
+    for (int i = 0; i < 3; i++){
+      if (peaks[i] == 0 || magnitude[k] > magnitude[peaks[i]]){
+        for (int j = 2; j > i; j--) peaks[j] = peaks[j - 1];
+        peaks[i] = k;
+        break;
+      }
+    }
+  }
+  
+  printf("\n  %u bins of %u Hz, DC ", points / 2, fftRate / points);
+  printDecibels(magnitude[0]);
+  printf("\n");
+  for (int i = 0; i < 3 && peaks[i] != 0; i++){
+    printf("  peak bin %u (%u Hz): %u, ", peaks[i], peaks[i] * fftRate / points, magnitude[peaks[i]]);
+    printDecibels(magnitude[peaks[i]]);
+    printf("\n");
+  }
+  printf("\n");
+  
+  if (plot != 0){
+    plotSpectrum(plot == 2);
+  }
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND GETTER :: spectrumGetter
+  
+   - lists frequency, magnitude and level of every bin of the last fft
+   - return success value
+===================================================================================================
+*/
+int spectrumGetter(CmdArgs* args){
+  uint16_t* magnitude = (uint16_t*)fftBuffer;
+  if (fftPoints == 0){
+    printf("  no fft yet\n\n");
+    return CMD_SUCCESS;
+  }
+  printf("\n  bin  Hz  magnitude  level\n");
+  for (uint32_t k = 0; k < fftPoints / 2; k++){
+    printf("  %u  %u  %u  ", k, k * fftRate / fftPoints, magnitude[k]);
+    printDecibels(magnitude[k]);
+    printf("\n");
+  }
+  printf("\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: packTestHandler
+  
+   - encodes the whole last capture the way FRAME_PACKED sends it, asking for PACK_TEST_SAMPLES
+     per chunk, decodes every chunk back and compares, then prints the size against raw samples
+   - return success value
+===================================================================================================
+*/
+int packTestHandler(CmdArgs* args){
+  static uint8_t chunk[FRAME_MAX_PAYLOAD - 1];   // room after the status byte, static for the 1k stack
+  static uint16_t decoded[PACK_TEST_SAMPLES];
+  uint8_t mode;
+  
+  if (strcmp(args->arg[0], "raw") == 0){
+    mode = PACK_RAW;
+  } else if (strcmp(args->arg[0], "12bit") == 0){
+    mode = PACK_12BIT;
+  } else if (strcmp(args->arg[0], "rice") == 0){
+    mode = PACK_RICE;
+  } else {
+    printf("ERROR: Mode must be raw, 12bit or rice!\n\n");
+    return CMD_FAILURE;
+  }
+  if (ADCBufferPointer == NULL || ADCstatus == ADC_STATUS_BUSY || ADCsamplesMax == 0){
+    printf("ERROR: Needs a finished capture!\n\n");
+    return CMD_FAILURE;
+  }
+  
+  uint32_t bytes = 0;
+  uint32_t chunks = 0;
+  for (uint32_t done = 0; done < ADCsamplesMax; chunks++){
+    uint32_t encoded;
+    uint32_t count = (ADCsamplesMax - done < PACK_TEST_SAMPLES) ? ADCsamplesMax - done : PACK_TEST_SAMPLES;
+    uint32_t length = PACK_Encode(mode, &ADCBufferPointer[done], count, chunk, sizeof(chunk), &encoded);
+    if (length == 0){
+      printf("ERROR: Sample %u can't be coded in this mode!\n\n", done);
+      return CMD_FAILURE;
+    }
+    if (PACK_Decode(chunk, length, decoded, PACK_TEST_SAMPLES) != encoded ||
+        memcmp(decoded, &ADCBufferPointer[done], encoded * sizeof(uint16_t)) != 0){
+      printf("ERROR: Chunk at sample %u didn't decode to the same samples!\n\n", done);
+      return CMD_FAILURE;
+    }
+    done += encoded;
+    bytes += length;
+  }
+  printf("  %u samples in %u chunks, %u bytes (%u.%02u bits/sample, raw is 16)\n\n", ADCsamplesMax, chunks,
+         bytes, bytes * 8 / ADCsamplesMax, (bytes * 800 / ADCsamplesMax) % 100);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: scriptBeginHandler
+  
+   - starts storing shell lines as the script
+   - return success value
+===================================================================================================
+*/
+int scriptBeginHandler(CmdArgs* args){
+  SCRIPT_Begin();
+  printf("  Enter commands, one per line, then \"end\".\n\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: scriptRunHandler
+  
+   - runs the script back to back, printing cycles per command
+   - return success value
+===================================================================================================
+*/
+int scriptRunHandler(CmdArgs* args){
+  return SCRIPT_Run();
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: scriptListHandler
+  
+   - prints the script
+   - return success value
+===================================================================================================
+*/
+int scriptListHandler(CmdArgs* args){
+  printf("\n");
+  SCRIPT_List();
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: scriptClearHandler
+  
+   - empties the script (the EEPROM copy stays until the next save)
+   - return success value
+===================================================================================================
+*/
+int scriptClearHandler(CmdArgs* args){
+  SCRIPT_Clear();
+  printf("  Script cleared.\n\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: scriptSaveHandler
+  
+   - saves the script to EEPROM
+   - return success value
+===================================================================================================
+*/
+int scriptSaveHandler(CmdArgs* args){
+  if (SCRIPT_Save() != CMD_SUCCESS){
+    printf("ERROR: EEPROM write failed.\n\n");
+    return CMD_FAILURE;
+  }
+  printf("  Script saved to EEPROM.\n\n");
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMMAND HANDLER :: scriptLoadHandler
+  
+   - loads the script from EEPROM
+   - return success value
+===================================================================================================
+*/
+int scriptLoadHandler(CmdArgs* args){
+  if (SCRIPT_Load() != CMD_SUCCESS){
+    printf("ERROR: No script saved in EEPROM, or the saved one is corrupt!\n\n");
+    return CMD_FAILURE;
+  }
+  printf("  Script loaded from EEPROM.\n\n");
+  return CMD_SUCCESS;
+}
+
+/*
+========================================================================================================================
+==========                                   FRAME COMMAND HANDLER FUNCTIONS                                  ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  FRAME HANDLER :: pingFrameHandler
+  
+   - echoes the payload back, used by the host to measure round trip time
+   - return success value
+===================================================================================================
+*/
+int pingFrameHandler(uint8_t* payload, uint8_t length){
+  return FRAME_Respond(FRAME_PING, CMD_SUCCESS, payload, length);
+}
+
+/*
+===================================================================================================
+  FRAME HANDLER :: setFrameHandler
+  
+   - [param:1] [value:4], sets an environment variable with the same limits as the text shell
+   - return success value
+===================================================================================================
+*/
+int setFrameHandler(uint8_t* payload, uint8_t length){
+  if (length < 5){
+    return FRAME_Respond(FRAME_SET, CMD_FAILURE, NULL, 0);
+  }
+  uint32_t value = FRAME_ReadU32(&payload[1]);
+  
+  switch (payload[0]){
+    case FRAME_PARAM_PWM_FREQ:
+      if (value >= 100000) break;
+      return FRAME_Respond(FRAME_SET, PARAM_Set(PARAM_PWM_FREQ, value), NULL, 0);
+    case FRAME_PARAM_PWM_DUTY:
+      if (value >= 100) break;
+      return FRAME_Respond(FRAME_SET, PARAM_Set(PARAM_PWM_DUTY, value), NULL, 0);
+  }
+  return FRAME_Respond(FRAME_SET, CMD_FAILURE, NULL, 0);
+}
+
+/*
+===================================================================================================
+  FRAME HANDLER :: getFrameHandler
+  
+   - [param:1], responds with the 4 byte value of an environment variable
+   - return success value
+===================================================================================================
+*/
+int getFrameHandler(uint8_t* payload, uint8_t length){
+  uint8_t value[4];
+  if (length < 1){
+    return FRAME_Respond(FRAME_GET, CMD_FAILURE, NULL, 0);
+  }
+  
+  switch (payload[0]){
+    case FRAME_PARAM_PWM_FREQ:
+      FRAME_WriteU32(value, PWM0A_GetFrequency());
+      break;
+    case FRAME_PARAM_PWM_DUTY:
+      FRAME_WriteU32(value, PWM0A_GetDutyPercent());
+      break;
+    case FRAME_PARAM_ADC_STATUS:
+      FRAME_WriteU32(value, ADC_Status());
+      break;
+    default:
+      return FRAME_Respond(FRAME_GET, CMD_FAILURE, NULL, 0);
+  }
+  return FRAME_Respond(FRAME_GET, CMD_SUCCESS, value, sizeof(value));
+}
+
+/*
+===================================================================================================
+  FRAME HANDLER :: runFrameHandler
+  
+   - [command:1] [args], runs a command
+   - return success value
+===================================================================================================
+*/
+int runFrameHandler(uint8_t* payload, uint8_t length){
+  if (length >= 6 && payload[0] == FRAME_RUN_ADC_COLLECT){
+    uint8_t response[2] = { 0, 0 };       // reason, job id
+    response[0] = adcStartCollection(&payload[1], 1, FRAME_ReadU16(&payload[2]), FRAME_ReadU16(&payload[4]), &response[1]);
+    return FRAME_Respond(FRAME_RUN, (response[0] == ADC_START_OK) ? CMD_SUCCESS : CMD_FAILURE, response, 2);
+  }
+  return FRAME_Respond(FRAME_RUN, CMD_FAILURE, NULL, 0);
+}
+
+/*
+===================================================================================================
+  FRAME HANDLER :: samplesFrameHandler
+  
+   - [offset:4] [count:1], responds with count raw little endian samples from the last capture
+   - return success value
+===================================================================================================
+*/
+int samplesFrameHandler(uint8_t* payload, uint8_t length){
+  if (length < 5 || ADCBufferPointer == NULL){
+    return FRAME_Respond(FRAME_SAMPLES, CMD_FAILURE, NULL, 0);
+  }
+  uint32_t offset = FRAME_ReadU32(&payload[0]);
+  uint32_t count = payload[4];
+  
+  // samples must fit in one frame after the status byte and must have been captured (offset
+  // first, offset + count wraps for offsets near 2^32)
+  if (count > (FRAME_MAX_PAYLOAD - 1) / sizeof(*ADCBufferPointer) || offset > ADCsamplesMax ||
+      count > ADCsamplesMax - offset){
+    return FRAME_Respond(FRAME_SAMPLES, CMD_FAILURE, NULL, 0);
+  }
+  
+  // the buffer is already little endian, send it as is
+  return FRAME_Respond(FRAME_SAMPLES, CMD_SUCCESS, (uint8_t*)&ADCBufferPointer[offset],
+                       count * sizeof(*ADCBufferPointer));
+}
+
+/*
+===================================================================================================
+  FRAME HANDLER :: packedFrameHandler
+  
+   - [offset:4] [count:2] [mode:1], responds with one chunk holding as many of the count samples
+     from offset as fit in a frame, the chunk header says how many that was
+   - return success value
+===================================================================================================
+*/
+int packedFrameHandler(uint8_t* payload, uint8_t length){
+  static uint8_t chunk[FRAME_MAX_PAYLOAD - 1];   // room after the status byte
+  if (length < 7 || ADCBufferPointer == NULL){
+    return FRAME_Respond(FRAME_PACKED, CMD_FAILURE, NULL, 0);
+  }
+  uint32_t offset = FRAME_ReadU32(&payload[0]);
+  uint32_t count = FRAME_ReadU16(&payload[4]);
+  if (count == 0 || offset >= ADCsamplesMax){
+    return FRAME_Respond(FRAME_PACKED, CMD_FAILURE, NULL, 0);
+  }
+  if (count > ADCsamplesMax - offset){
+    count = ADCsamplesMax - offset;
+  }
+  
+  uint32_t encoded;
+  uint32_t size = PACK_Encode(payload[6], &ADCBufferPointer[offset], count, chunk, sizeof(chunk), &encoded);
+  if (size == 0){
+    return FRAME_Respond(FRAME_PACKED, CMD_FAILURE, NULL, 0);
+  }
+  return FRAME_Respond(FRAME_PACKED, CMD_SUCCESS, chunk, size);
+}
+
+/*
+===================================================================================================
+  FRAME HANDLER :: infoFrameHandler
+  
+   - responds with the last capture's header: [startMs:4] [startCycles:4] [periodCycles:4]
+     [sampleCycles:4] [rateMilliHz:4] [requestedHz:4] [samples:4] [channel:1] [channels:1]
+     [bits:1] [flags:1]
+   - return success value
+===================================================================================================
+*/
+int infoFrameHandler(uint8_t* payload, uint8_t length){
+  uint8_t data[32];
+  long sr = StartCritical();
+  ADC_BlockHeader header = ADCheader;
+  EndCritical(sr);
+  if (header.periodCycles == 0){
+    return FRAME_Respond(FRAME_INFO, CMD_FAILURE, NULL, 0);
+  }
+  FRAME_WriteU32(&data[0], header.startMs);
+  FRAME_WriteU32(&data[4], header.startCycles);
+  FRAME_WriteU32(&data[8], header.periodCycles);
+  FRAME_WriteU32(&data[12], header.sampleCycles);
+  FRAME_WriteU32(&data[16], header.rateMilliHz);
+  FRAME_WriteU32(&data[20], header.requestedHz);
+  FRAME_WriteU32(&data[24], header.samples);
+  data[28] = header.channel;
+  data[29] = header.channels;
+  data[30] = header.bits;
+  data[31] = header.flags;
+  return FRAME_Respond(FRAME_INFO, CMD_SUCCESS, data, sizeof(data));
+}
@@ -9,22 +9,43 @@
 
 #include "defs.h"
 
-/*
-========================================================================================================================
-==========                                       EXTERNAL DEPENDENCIES                                        ==========
-========================================================================================================================
-*/
-
-extern uint32_t RxFifo_Get(char*);
-
 /*
 ========================================================================================================================
 ==========                                     DATA STRUCTURE DEFINITIONS                                     ==========
 ========================================================================================================================
 */
 
+// argument types for ArgSpec
+#define ARG_END   0                 // terminates an argument schema
+#define ARG_INT   1                 // signed decimal integer
+#define ARG_FIXED 2                 // signed decimal with up to 3 fraction digits, value in thousandths
+#define ARG_HEX   3                 // unsigned hexadecimal, 0x prefix optional
+#define ARG_WORD  4                 // any token, interpreted by the handler
+
+#define ARG_FIXED_SCALE 1000        // ARG_FIXED value of 1.000
+#define CMD_MAX_ARGS 8              // most arguments a schema can declare
+
+// one declared argument: parsed and range checked before the handler runs, and used to
+// generate usage text
+typedef struct {
+    uint8_t type;                   // ARG_*
+    char* name;                     // shown in usage text
+    int32_t min;                    // inclusive range, in thousandths for ARG_FIXED
+    int32_t max;
+    char* units;                    // shown after the range, or the choices of an ARG_WORD
+} ArgSpec;
+
+// arguments handed to a command handler
+typedef struct {
+    char** tokens;                  // the whole line
+    uint8_t numTokens;
+    char** arg;                     // the tokens after the command key(s)
+    uint8_t count;                  // number of tokens in arg
+    int32_t value[CMD_MAX_ARGS];    // parsed value of each declared numeric argument
+} CmdArgs;
+
 // defines command handler function signature
-typedef int (*cmdFunc)(char**, uint8_t);
+typedef int (*cmdFunc)(CmdArgs* args);
 
 // command data structure definition
 typedef struct command_t {
@@ -32,6 +53,7 @@ typedef struct command_t {
     cmdFunc function;               // pointer to function that handles command exectuion
     struct command_t* childArray;   // pointer to array of child functions (e.g, the commands associated with set)
     char* helpText;                 // text to print for help display
+    const ArgSpec* args;            // argument schema terminated by ARG_END, NULL if the handler parses its own
 } Command;
 
 /*
@@ -44,6 +66,8 @@ extern Command mainCommands[];
 extern Command setCommands[];
 extern Command getCommands[];
 extern Command runCommands[];
+extern Command scriptCommands[];
+extern uint16_t CMD_MainCount;
 
 /*
 ========================================================================================================================
@@ -52,26 +76,89 @@ extern Command runCommands[];
 */
 
 // main command prototypes
-int setHandler(char** tokens, uint8_t numTokens);
-int getHandler(char** tokens, uint8_t numTokens);
-int runHandler(char** tokens, uint8_t numTokens);
-int helpHandler(char** tokens, uint8_t numTokens);
+int setHandler(CmdArgs* args);
+int getHandler(CmdArgs* args);
+int runHandler(CmdArgs* args);
+int scriptHandler(CmdArgs* args);
+int helpHandler(CmdArgs* args);
+int jobsHandler(CmdArgs* args);
+int waitHandler(CmdArgs* args);
+int killHandler(CmdArgs* args);
 
 // set command prototypes
-int pwmFreqSetter(char** tokens, uint8_t numTokens);
-int pwmPeriodHandler(char** tokens, uint8_t numTokens);
-int pwmDutySetter(char** tokens, uint8_t numTokens);
-int pwmDutyTimeHandler(char** tokens, uint8_t numTokens);
+int pwmFreqSetter(CmdArgs* args);
+int pwmPeriodHandler(CmdArgs* args);
+int pwmDutySetter(CmdArgs* args);
+int pwmDutyTimeHandler(CmdArgs* args);
+int logLevelSetter(CmdArgs* args);
+int flowControlSetter(CmdArgs* args);
+int telemetryPortSetter(CmdArgs* args);
+int paramSetter(CmdArgs* args);
+int adcAverageSetter(CmdArgs* args);
+int adcStatsSetter(CmdArgs* args);
+int filterTapsSetter(CmdArgs* args);
+int filterBiquadSetter(CmdArgs* args);
+int filterAverageSetter(CmdArgs* args);
+int filterDecimateSetter(CmdArgs* args);
+int adcCalSetter(CmdArgs* args);
+int adcLutSetter(CmdArgs* args);
+int adcLutPointsSetter(CmdArgs* args);
 
 // get command prototypes
-int pwmFreqGetter(char** tokens, uint8_t numTokens);
+int pwmFreqGetter(CmdArgs* args);
+int logLevelGetter(CmdArgs* args);
+int uartStatsGetter(CmdArgs* args);
+int paramsGetter(CmdArgs* args);
+int adcStreamGetter(CmdArgs* args);
+int scopeGetter(CmdArgs* args);
+int adcScanGetter(CmdArgs* args);
+int adcStatsGetter(CmdArgs* args);
+int filterGetter(CmdArgs* args);
+int spectrumGetter(CmdArgs* args);
+int adcInfoGetter(CmdArgs* args);
+int adcCalGetter(CmdArgs* args);
+int adcWatchGetter(CmdArgs* args);
 
 // run command prototypes
-int adcTestHandler(char** tokens, uint8_t numTokens);
-int ledTogglerHandler(char** tokens, uint8_t numTokens);
-int ledDisablerHandler(char** tokens, uint8_t numTokens);
-int helloTopScreenHandler(char** tokens, uint8_t numTokens);
-int helloBottomScreenHandler(char** tokens, uint8_t numTokens);
+int adcTestHandler(CmdArgs* args);
+int adcMultiHandler(CmdArgs* args);
+int adcStreamHandler(CmdArgs* args);
+int adcScanHandler(CmdArgs* args);
+int adcDualHandler(CmdArgs* args);
+int scopeHandler(CmdArgs* args);
+int ledTogglerHandler(CmdArgs* args);
+int ledDisablerHandler(CmdArgs* args);
+int helloTopScreenHandler(CmdArgs* args);
+int helloBottomScreenHandler(CmdArgs* args);
+int uartOpenHandler(CmdArgs* args);
+int uartSendHandler(CmdArgs* args);
+int paramSaveHandler(CmdArgs* args);
+int paramLoadHandler(CmdArgs* args);
+int paramDefaultsHandler(CmdArgs* args);
+int filterClearHandler(CmdArgs* args);
+int filterCaptureHandler(CmdArgs* args);
+int calCaptureHandler(CmdArgs* args);
+int adcWatchHandler(CmdArgs* args);
+int adcUnwatchHandler(CmdArgs* args);
+int fftHandler(CmdArgs* args);
+int packTestHandler(CmdArgs* args);
+
+// script command prototypes
+int scriptBeginHandler(CmdArgs* args);
+int scriptRunHandler(CmdArgs* args);
+int scriptListHandler(CmdArgs* args);
+int scriptClearHandler(CmdArgs* args);
+int scriptSaveHandler(CmdArgs* args);
+int scriptLoadHandler(CmdArgs* args);
+
+// frame command prototypes
+int pingFrameHandler(uint8_t* payload, uint8_t length);
+int setFrameHandler(uint8_t* payload, uint8_t length);
+int getFrameHandler(uint8_t* payload, uint8_t length);
+int runFrameHandler(uint8_t* payload, uint8_t length);
+int samplesFrameHandler(uint8_t* payload, uint8_t length);
+int packedFrameHandler(uint8_t* payload, uint8_t length);
+int infoFrameHandler(uint8_t* payload, uint8_t length);
 
 // tasks (for now)
 void ledTogglerTask(void);
@@ -79,4 +166,12 @@ void ledTogglerTask(void);
 // helpers
 void printHelp(Command* commandArray, char* indent);
 
+// sorts the command tables at boot, after which CMD_Lookup binary searches them
+void CMD_Init(void);
+Command* CMD_Lookup(Command* table, uint16_t length, const char* key);
+
+// parses and checks tokens[depth...] against the command's schema, then runs its handler,
+// depth is the number of keys in front of the arguments (1 for "help", 2 for "set pwmFreq")
+int CMD_Execute(Command* command, char** tokens, uint8_t numTokens, uint8_t depth);
+
 #endif
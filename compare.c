@@ -0,0 +1,252 @@
+#include "tm4c123gh6pm.h"
+#include "compare.h"
+#include "adc.h"
+#include "os.h"
+#include "fifo.h"
+#include "defs.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+#define FIFOSUCCESS 1         // return value on success
+#define FIFOFAIL    0         // return value on failure
+
+#define COMPARE_WATCH_MASK ((1 << COMPARE_MAX) - 1)
+
+// comparator registers of watch n
+#define COMPARE_DCCTL(n)  ((&ADC1_DCCTL0_R)[n])
+#define COMPARE_DCCMP(n)  ((&ADC1_DCCMP0_R)[n])
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+COMPARE_Watch COMPARE_Watches[COMPARE_MAX];
+uint32_t COMPARE_DroppedEvents = 0;
+
+const char* const COMPARE_RegionNames[3] = { "off", "above", "below" };
+
+// events from the comparator interrupt to the main loop (see FIFO.h)
+AddIndexFifo(CompareEvent, COMPARE_QUEUE, COMPARE_Event, FIFOSUCCESS, FIFOFAIL)
+
+/*
+========================================================================================================================
+==========                                          COMPARE FUNCTIONS                                         ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  COMPARE :: COMPARE_Control
+
+   - comparator control for a watch: interrupt once on entering the band that ends its current
+     state, the region's band while outside, the opposite band while inside
+===================================================================================================
+*/
+static uint32_t COMPARE_Control(const COMPARE_Watch* watch){
+  bool high = (watch->region == COMPARE_ABOVE) != watch->inside;
+  return ADC_DCCTL0_CIE | ADC_DCCTL0_CIM_ONCE | (high ? ADC_DCCTL0_CIC_HIGH : ADC_DCCTL0_CIC_LOW);
+}
+
+/*
+===================================================================================================
+  COMPARE :: COMPARE_Sequence
+
+   - rebuilds ADC1 sequencer 2 with a step per armed watch, each sent to the watch's comparator,
+     and runs it continuously while any watch is armed (called with sequencer 2 disabled)
+===================================================================================================
+*/
+static void COMPARE_Sequence(void){
+  uint32_t mux = 0;
+  uint32_t op = 0;
+  uint32_t dc = 0;
+  int steps = 0;
+
+  for (int i = 0; i < COMPARE_MAX; i++){
+    if (COMPARE_Watches[i].region != COMPARE_OFF){
+      mux |= COMPARE_Watches[i].channel << (4*steps);
+      op |= ADC_SSOP2_S0DCOP << (4*steps);         // to the comparator, not the FIFO
+      dc |= i << (4*steps);
+      steps++;
+    }
+  }
+  if (steps == 0){
+    ADC1_IM_R &= ~ADC_IM_DCONSS2;
+    return;
+  }
+
+  ADC1_SSMUX2_R = mux;
+  ADC1_SSOP2_R = op;
+  ADC1_SSDC2_R = dc;
+  ADC1_SSCTL2_R = 0x02 << (4*(steps - 1));         // end after the last step, no FIFO interrupt
+  ADC1_SSPRI_R = 0x2310;                           // sequencer 2 lowest, it never stops asking
+  ADC1_EMUX_R = (ADC1_EMUX_R&0xFFFFF0FF)+0x0F00;   // always trigger, convert continuously
+  ADC1_IM_R |= ADC_IM_DCONSS2;                     // comparator interrupts on the SS2 vector
+  ADC1_ACTSS_R |= 0x04;
+}
+
+/*
+===================================================================================================
+  COMPARE :: COMPARE_Arm
+
+   - watches channel for a region around level on comparator watch, not during a dual capture
+   - return success value
+===================================================================================================
+*/
+int COMPARE_Arm(uint8_t watch, uint8_t channel, uint8_t region, uint16_t level, uint16_t hysteresis){
+  // the low band is <= COMP0 and the high band > COMP1, so the references sit one code under
+  // the levels, and the level a region is left at must exist
+  uint32_t comp0, comp1;
+  if (watch >= COMPARE_MAX || level > 4095){
+    return CMD_FAILURE;
+  }
+  if (region == COMPARE_ABOVE && level > hysteresis){
+    comp1 = level - 1;
+    comp0 = level - hysteresis - 1;
+  } else if (region == COMPARE_BELOW && level > 0 && level + hysteresis <= 4095){
+    comp0 = level - 1;
+    comp1 = level + hysteresis - 1;
+  } else {
+    return CMD_FAILURE;
+  }
+  if ((SYSCTL_PRADC_R & SYSCTL_PRADC_R1) && (ADC1_ACTSS_R & 0x08)){
+    return CMD_FAILURE;                            // a dual capture owns ADC1 (see compare.h)
+  }
+  if (ADC_Pin_Config(channel)){
+    return CMD_FAILURE;
+  }
+
+  if ((SYSCTL_PRADC_R & SYSCTL_PRADC_R1) == 0){
+    SYSCTL_RCGCADC_R |= 0x02;                      // activate ADC1
+    while((SYSCTL_PRADC_R&SYSCTL_PRADC_R1)==0){}   // allow time to finish activating
+    ADC1_PC_R = ADC_PP_MSR_125K;                   // plenty for a watch (a dual capture speeds it up)
+    NVIC_PRI12_R = (NVIC_PRI12_R&0xFF00FFFF)|0x00600000; // priority 3
+    NVIC_EN1_R = 1<<(50-32);                       // enable interrupt 50 in NVIC
+  }
+
+  long sr = StartCritical();
+  ADC1_ACTSS_R &= ~0x04;                           // disable sample sequencer 2 while it changes
+  COMPARE_Watch* w = &COMPARE_Watches[watch];
+  w->region = region;
+  w->channel = channel;
+  w->level = level;
+  w->hysteresis = hysteresis;
+  w->inside = false;
+  w->enters = 0;
+  w->leaves = 0;
+  w->lastMs = 0;
+  COMPARE_DCCMP(watch) = (comp1 << 16) | comp0;
+  COMPARE_DCCTL(watch) = COMPARE_Control(w);
+  ADC1_DCRIC_R = ADC_DCRIC_DCINT0 << watch;        // forget the band of the previous watch
+  ADC1_DCISC_R = ADC_DCISC_DCINT0 << watch;
+  COMPARE_Sequence();
+  EndCritical(sr);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  COMPARE :: COMPARE_Disarm
+
+   - stops a watch, sequencer 2 stops with the last one
+===================================================================================================
+*/
+void COMPARE_Disarm(uint8_t watch){
+  if (watch >= COMPARE_MAX || COMPARE_Watches[watch].region == COMPARE_OFF){
+    return;
+  }
+  long sr = StartCritical();
+  ADC1_ACTSS_R &= ~0x04;
+  COMPARE_Watches[watch].region = COMPARE_OFF;
+  COMPARE_DCCTL(watch) = 0;
+  ADC1_DCISC_R = ADC_DCISC_DCINT0 << watch;
+  COMPARE_Sequence();
+  EndCritical(sr);
+}
+
+/*
+===================================================================================================
+  COMPARE :: COMPARE_Armed
+
+   - true while any watch is armed, sequencer 2 is converting then
+===================================================================================================
+*/
+bool COMPARE_Armed(void){
+  for (int i = 0; i < COMPARE_MAX; i++){
+    if (COMPARE_Watches[i].region != COMPARE_OFF){
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+===================================================================================================
+  COMPARE :: COMPARE_GetEvent
+
+   - takes the oldest event the interrupt queued
+===================================================================================================
+*/
+bool COMPARE_GetEvent(COMPARE_Event* event){
+  return (CompareEventFifo_Get(event) == FIFOSUCCESS);
+}
+
+/*
+===================================================================================================
+  COMPARE :: COMPARE_Report
+
+   - prints every queued event, like JOB_Poll does for finished jobs
+===================================================================================================
+*/
+void COMPARE_Report(void){
+  COMPARE_Event event;
+  while (COMPARE_GetEvent(&event)){
+    const COMPARE_Watch* watch = &COMPARE_Watches[event.watch];
+    printf("[watch %d] channel %d %s %s %d at %u ms\n", event.watch, watch->channel,
+           event.entered ? "entered" : "left", COMPARE_RegionNames[watch->region], watch->level, event.ms);
+  }
+}
+
+/*
+===================================================================================================
+  COMPARE :: ADC1Seq2_Handler
+
+   - comparator interrupt: flips each watch that fired between entering and leaving, re-arming
+     its comparator for the opposite band, queues the events and wakes the main loop
+===================================================================================================
+*/
+void ADC1Seq2_Handler(void){
+  uint32_t fired = ADC1_DCISC_R & COMPARE_WATCH_MASK;
+  ADC1_DCISC_R = fired;                            // also clears the SS2 comparator interrupt
+  uint32_t now = OS_ReadPeriodicTime();
+
+  for (int i = 0; i < COMPARE_MAX; i++){
+    COMPARE_Watch* watch = &COMPARE_Watches[i];
+    if ((fired & (1 << i)) == 0 || watch->region == COMPARE_OFF){
+      continue;
+    }
+    watch->inside = !watch->inside;
+    if (watch->inside){
+      watch->enters++;
+    } else {
+      watch->leaves++;
+    }
+    watch->lastMs = now;
+    COMPARE_DCCTL(i) = COMPARE_Control(watch);
+
+    COMPARE_Event event = { i, watch->inside, now };
+    if (CompareEventFifo_Put(event) == FIFOFAIL){
+      COMPARE_DroppedEvents++;
+    }
+  }
+  OS_SignalEvents(OS_EVENT_COMPARE);
+}
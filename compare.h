@@ -0,0 +1,66 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Threshold watches on the ADC1 digital comparators. ADC1's sequencer 2 converts the watched
+// channels continuously (always trigger) and sends every result to its watch's comparator
+// instead of the FIFO, so a watch costs no CPU until its signal enters or leaves the region.
+// A dual capture can't share ADC1 with watches: its sequencer 3 trigger would wait for the
+// sequence 2 conversion under way (up to four), so ADC1 would lag ADC0 by a varying amount and
+// the phase setting would mean nothing. adcDual refuses while a watch is armed, and no watch
+// can be armed during a dual capture. The comparator interrupt
+// queues the event and signals OS_EVENT_COMPARE, the main loop reports it (COMPARE_Report).
+//
+// A region is above a level (entered at >= level, left below level - hysteresis) or below it
+// (entered below level, left at >= level + hysteresis). The interrupt swaps the comparator
+// between the two bands, so the hysteresis band never fires. A signal already in the region
+// when armed reports entering at once. A crossing back faster than the interrupt latency
+// (a few us) can be missed.
+
+#define COMPARE_MAX        4          // watches, one sequencer 2 step and comparator each
+#define COMPARE_QUEUE      8          // events waiting for the main loop (must be power of 2)
+
+// regions
+#define COMPARE_OFF        0
+#define COMPARE_ABOVE      1
+#define COMPARE_BELOW      2
+
+typedef struct {
+  uint8_t region;                     // COMPARE_*, COMPARE_OFF if unused
+  uint8_t channel;
+  uint16_t level;
+  uint16_t hysteresis;
+  bool inside;                        // last event was entering
+  uint32_t enters;                    // events since armed
+  uint32_t leaves;
+  uint32_t lastMs;                    // OS_ReadPeriodicTime at the last event
+} COMPARE_Watch;
+
+typedef struct {
+  uint8_t watch;
+  bool entered;                       // false: left
+  uint32_t ms;
+} COMPARE_Event;
+
+extern COMPARE_Watch COMPARE_Watches[COMPARE_MAX];
+extern uint32_t COMPARE_DroppedEvents;
+
+extern const char* const COMPARE_RegionNames[3];
+
+// arms watch on channel for a region around level, replacing what it watched before, returns
+// CMD_FAILURE if an argument is out of range
+int COMPARE_Arm(uint8_t watch, uint8_t channel, uint8_t region, uint16_t level, uint16_t hysteresis);
+void COMPARE_Disarm(uint8_t watch);
+bool COMPARE_Armed(void);             // true while any watch is armed
+
+// takes the oldest queued event, false if there is none
+bool COMPARE_GetEvent(COMPARE_Event* event);
+
+// prints every queued event, called by the main loop on OS_EVENT_COMPARE
+void COMPARE_Report(void);
+
+void ADC1Seq2_Handler(void);
+
+#endif
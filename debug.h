@@ -8,25 +8,26 @@
 #include <errno.h>
 #include <string.h>
 
+#include "log.h"
+
+// BOB enables the debug LED macros, logging is controlled by log.h levels instead
 #define BOB
 
 #define PF1 (*((volatile uint32_t *)0x40025008)) // red
 #define PF2 (*((volatile uint32_t *)0x40025010)) // blue
 #define PF3 (*((volatile uint32_t *)0x40025020)) // green
 
+// old debug macros, now leveled MAIN module log messages (see log.h)
+#define debug(...)      LOG_DEBUG(MAIN, __VA_ARGS__)
+#define debug_err(...)  LOG_ERR(MAIN, __VA_ARGS__)
+#define debug_warn(...) LOG_WARN(MAIN, __VA_ARGS__)
+#define debug_info(...) LOG_INFO(MAIN, __VA_ARGS__)
+
 #ifdef BOB
-    #define debug(M, ...) printf("DEBUG %s:%d: " M "\n")
-    #define debug_err(M, ...) printf("[ERROR] (%s:%d: errno: %s) " M "\n")
-    #define debug_warn(M, ...) printf("[WARN] (%s:%d: errno: %s) " M "\n")
-    #define debug_info(M, ...) printf("[INFO] (%s:%d) " M "\n")
 		#define debug_ledToggle(M) M ^= 0xFF
     #define debug_ledOn(M) M |= 0xFF
     #define debug_ledOff(M) M &= 0x00
 #else
-    #define debug(M, ...)
-    #define debug_err(M, ...)
-    #define debug_warn(M, ...)
-    #define debug_info(M, ...)
   	#define debug_ledToggle(M)
     #define debug_ledOn(M)
     #define debug_ledOff(M)
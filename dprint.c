@@ -0,0 +1,118 @@
+#include "dprint.h"
+#include "fifo.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+#define FIFOSUCCESS 1         // return value on success
+#define FIFOFAIL    0         // return value on failure
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+uint32_t DPRINT_Dropped = 0;
+
+/*
+========================================================================================================================
+==========                                      DEFERRED PRINT FUNCTIONS                                      ==========
+========================================================================================================================
+*/
+
+// create index implementation FIFO of captured messages (see FIFO.h)
+AddIndexFifo(DPrint, DPRINT_QUEUE_SIZE, DPRINT_Entry, FIFOSUCCESS, FIFOFAIL)
+
+/*
+===================================================================================================
+  DPRINT :: DPRINT_Init
+  
+   - empties the message ring
+===================================================================================================
+*/
+void DPRINT_Init(void){
+  DPrintFifo_Init();
+  DPRINT_Dropped = 0;
+}
+
+/*
+===================================================================================================
+  DPRINT :: DPRINT_Capture
+  
+   - captures the tag, format pointer and raw arguments, no formatting is done here
+   - may be called from any interrupt priority
+===================================================================================================
+*/
+static void DPRINT_Capture(const char* tag, uint32_t numArgs, const char* format, va_list args){
+  DPRINT_Entry entry;
+  
+  if (numArgs > DPRINT_MAX_ARGS){
+    numArgs = DPRINT_MAX_ARGS;
+  }
+  entry.tag = tag;
+  entry.format = format;
+  entry.numArgs = numArgs;
+  for (uint32_t i = 0; i < DPRINT_MAX_ARGS; i++){
+    entry.args[i] = (i < numArgs) ? va_arg(args, uint32_t) : 0;
+  }
+  
+  long sr = StartCritical();              // producers run at several priorities
+  if (DPrintFifo_Put(entry) == FIFOFAIL){
+    DPRINT_Dropped++;
+  }
+  EndCritical(sr);
+}
+
+/*
+===================================================================================================
+  DPRINT :: DPRINT_Post
+  
+   - queues a message, see DPRINTF
+===================================================================================================
+*/
+void DPRINT_Post(uint32_t numArgs, const char* format, ...){
+  va_list args;
+  va_start(args, format);
+  DPRINT_Capture(NULL, numArgs, format, args);
+  va_end(args);
+}
+
+/*
+===================================================================================================
+  DPRINT :: DPRINT_PostTagged
+  
+   - queues a message that is printed as its own line after the tag
+===================================================================================================
+*/
+void DPRINT_PostTagged(const char* tag, uint32_t numArgs, const char* format, ...){
+  va_list args;
+  va_start(args, format);
+  DPRINT_Capture(tag, numArgs, format, args);
+  va_end(args);
+}
+
+/*
+===================================================================================================
+  DPRINT :: DPRINT_Flush
+  
+   - formats and transmits pending messages through printf
+   - unused argument slots are passed too, printf ignores arguments the format doesn't consume
+===================================================================================================
+*/
+void DPRINT_Flush(void){
+  DPRINT_Entry entry;
+  while (DPrintFifo_Get(&entry) == FIFOSUCCESS){
+    if (entry.tag != NULL) printf("%s", entry.tag);
+    printf(entry.format, entry.args[0], entry.args[1], entry.args[2], entry.args[3]);
+    if (entry.tag != NULL) printf("\n");
+  }
+}
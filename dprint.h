@@ -0,0 +1,52 @@
+#ifndef DPRINT_H
+#define DPRINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Deferred printf: DPRINTF captures the format string pointer and up to DPRINT_MAX_ARGS raw
+// 32-bit arguments into a ring, and DPRINT_Flush formats and transmits them later from the
+// main loop. Posting costs a short critical section and a copy, so it is safe in handlers.
+//
+// Restrictions, since formatting happens after the caller has moved on:
+//   - arguments must be 32-bit or smaller integers, chars or pointers (no float/double, no int64)
+//   - %s arguments and the format itself must still be valid at flush time (use literals/statics)
+//
+// e.g.,
+// DPRINTF("ADC done, %d samples\n", ADCsamples);
+
+#define DPRINT_MAX_ARGS   4
+#define DPRINT_QUEUE_SIZE 32        // number of pending messages (must be power of 2)
+
+// counts the arguments after the format string (0 to DPRINT_MAX_ARGS), 5 to 12 arguments
+// expand to an undeclared name so the call fails to compile instead of dropping arguments
+#define DPRINT_COUNT(...) DPRINT_COUNT_(__VA_ARGS__, DPRINT_TOO_MANY, DPRINT_TOO_MANY, DPRINT_TOO_MANY, \
+                                        DPRINT_TOO_MANY, DPRINT_TOO_MANY, DPRINT_TOO_MANY, DPRINT_TOO_MANY, \
+                                        DPRINT_TOO_MANY, 4, 3, 2, 1, 0, 0)
+#define DPRINT_COUNT_(fmt, a, b, c, d, e, f, g, h, i, j, k, l, N, ...) N
+#define DPRINT_TOO_MANY DPRINTF_takes_at_most_4_arguments
+
+#define DPRINTF(...) DPRINT_Post(DPRINT_COUNT(__VA_ARGS__), __VA_ARGS__)
+
+// one captured message
+typedef struct {
+  const char* tag;                  // printed before the message, with a newline after (NULL for none)
+  const char* format;
+  uint32_t numArgs;
+  uint32_t args[DPRINT_MAX_ARGS];
+} DPRINT_Entry;
+
+extern uint32_t DPRINT_Dropped;    // messages lost because the ring was full
+
+void DPRINT_Init(void);
+
+// captures a message, use DPRINTF rather than calling this directly
+void DPRINT_Post(uint32_t numArgs, const char* format, ...);
+
+// captures a message printed as one line: tag, formatted message, newline (used by log.h)
+void DPRINT_PostTagged(const char* tag, uint32_t numArgs, const char* format, ...);
+
+// formats and transmits every pending message, call from the main loop only
+void DPRINT_Flush(void);
+
+#endif
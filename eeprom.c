@@ -0,0 +1,131 @@
+#include "tm4c123gh6pm.h"
+#include "eeprom.h"
+#include "defs.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+#define WORDS_PER_BLOCK (EEPROM_BLOCK_SIZE / 4)
+
+#define EEDONE_ERRORS (EEPROM_EEDONE_INVPL | EEPROM_EEDONE_NOPERM)
+
+/*
+========================================================================================================================
+==========                                           EEPROM FUNCTIONS                                         ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  EEPROM :: EEPROM_WaitForDone
+  
+   - spins until the EEPROM finishes the current write, erase or copy (a few ms at most)
+===================================================================================================
+*/
+static void EEPROM_WaitForDone(void){
+  while (EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING) {};
+}
+
+/*
+===================================================================================================
+  EEPROM :: EEPROM_Init
+  
+   - enables the EEPROM, resetting it a second time as the datasheet requires so any write that
+     was cut short by a reset is recovered
+   - return success value
+===================================================================================================
+*/
+int EEPROM_Init(void){
+  SYSCTL_RCGCEEPROM_R |= SYSCTL_RCGCEEPROM_R0;           // activate EEPROM clock gating
+  while ((SYSCTL_PREEPROM_R & SYSCTL_PREEPROM_R0) == 0) {}; // wait for EEPROM to activate
+  EEPROM_WaitForDone();
+  if (EEPROM_EESUPP_R & (EEPROM_EESUPP_PRETRY | EEPROM_EESUPP_ERETRY)){
+    return CMD_FAILURE;
+  }
+
+  SYSCTL_SREEPROM_R |= SYSCTL_SREEPROM_R0;               // second reset
+  SYSCTL_SREEPROM_R &= ~SYSCTL_SREEPROM_R0;
+  while ((SYSCTL_PREEPROM_R & SYSCTL_PREEPROM_R0) == 0) {};
+  EEPROM_WaitForDone();
+  if (EEPROM_EESUPP_R & (EEPROM_EESUPP_PRETRY | EEPROM_EESUPP_ERETRY)){
+    return CMD_FAILURE;
+  }
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  EEPROM :: EEPROM_Seek
+  
+   - points the block and offset registers at a word aligned byte address
+   - return success value
+===================================================================================================
+*/
+static int EEPROM_Seek(uint32_t address, uint32_t words){
+  if ((address & 3) || address + words * 4 > EEPROM_SIZE){
+    return CMD_FAILURE;
+  }
+  EEPROM_EEBLOCK_R = address / EEPROM_BLOCK_SIZE;
+  EEPROM_EEOFFSET_R = (address / 4) % WORDS_PER_BLOCK;
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  EEPROM :: EEPROM_Read
+  
+   - reads words starting at a word aligned byte address
+   - return success value
+===================================================================================================
+*/
+int EEPROM_Read(uint32_t address, uint32_t* data, uint32_t words){
+  if (EEPROM_Seek(address, words) != CMD_SUCCESS){
+    return CMD_FAILURE;
+  }
+  uint32_t offset = EEPROM_EEOFFSET_R;
+  for (uint32_t i = 0; i < words; i++){
+    data[i] = EEPROM_EERDWRINC_R;                        // offset wraps within the block
+    if (++offset == WORDS_PER_BLOCK){
+      offset = 0;
+      EEPROM_EEBLOCK_R = EEPROM_EEBLOCK_R + 1;
+    }
+  }
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  EEPROM :: EEPROM_Write
+  
+   - writes words starting at a word aligned byte address, skipping words that already hold
+     the value so rewriting a mostly unchanged record costs little wear
+   - return success value
+===================================================================================================
+*/
+int EEPROM_Write(uint32_t address, const uint32_t* data, uint32_t words){
+  if (EEPROM_Seek(address, words) != CMD_SUCCESS){
+    return CMD_FAILURE;
+  }
+  uint32_t offset = EEPROM_EEOFFSET_R;
+  for (uint32_t i = 0; i < words; i++){
+    if (EEPROM_EERDWR_R != data[i]){
+      EEPROM_EERDWR_R = data[i];
+      EEPROM_WaitForDone();
+      if (EEPROM_EEDONE_R & EEDONE_ERRORS){
+        return CMD_FAILURE;
+      }
+    }
+    if (++offset == WORDS_PER_BLOCK){
+      offset = 0;
+      EEPROM_EEBLOCK_R = EEPROM_EEBLOCK_R + 1;
+    }
+    EEPROM_EEOFFSET_R = offset;
+  }
+  return CMD_SUCCESS;
+}
@@ -0,0 +1,31 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// On-chip EEPROM: 2KB as 32 blocks of 16 words, addressed here in bytes (word aligned).
+// Each word endures about 500k writes, so EEPROM_Write skips words that already hold the value.
+//
+// EEPROM map:
+//   0x000-0x3FF  shell script store (see script.h)
+//   0x400-0x7FF  parameter store (see params.h)
+
+#define EEPROM_SIZE           2048
+#define EEPROM_BLOCK_SIZE     64            // bytes per block
+
+#define EEPROM_SCRIPT_ADDRESS 0x000
+#define EEPROM_SCRIPT_SIZE    0x400
+
+#define EEPROM_PARAM_ADDRESS  0x400
+#define EEPROM_PARAM_SIZE     0x400
+
+// powers up the EEPROM and waits for it to recover from any interrupted write
+// return success value
+int EEPROM_Init(void);
+
+// read/write words starting at a word aligned byte address, return success value
+int EEPROM_Read(uint32_t address, uint32_t* data, uint32_t words);
+int EEPROM_Write(uint32_t address, const uint32_t* data, uint32_t words);
+
+#endif
@@ -0,0 +1,266 @@
+#include "fft.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+#define CIRCLE 1024           // angle units in a full turn, FFT_MAX_POINTS needs one per point
+
+// sin(2 pi k / CIRCLE) in Q15 for the first quarter turn, k = 0 to CIRCLE/4
+static const int16_t quarterSine[CIRCLE/4 + 1] = {
+  0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210, 2411, 2611, 2811, 3012,
+  3212, 3412, 3612, 3812, 4011, 4211, 4410, 4609, 4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195,
+  6393, 6590, 6787, 6983, 7180, 7376, 7571, 7767, 7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319,
+  9512, 9704, 9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605, 11793, 11980, 12167, 12354,
+  12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828, 14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+  15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673, 16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+  18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001, 20160, 20318, 20475, 20632,
+  20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856, 22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028,
+  23170, 23312, 23453, 23593, 23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+  25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199, 26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+  27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002, 28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803,
+  28899, 28993, 29086, 29178, 29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+  30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784, 30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298,
+  31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737, 31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099,
+  32138, 32177, 32214, 32251, 32286, 32319, 32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+  32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767,
+  32767
+};
+
+/*
+========================================================================================================================
+==========                                            FFT FUNCTIONS                                           ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  FFT :: sine
+  
+   - Q15 sine of angle (CIRCLE units, any value), from the quarter wave table
+===================================================================================================
+*/
+static int32_t sine(uint32_t angle){
+  angle &= CIRCLE - 1;
+  if (angle <= CIRCLE/4) return quarterSine[angle];
+  if (angle <= CIRCLE/2) return quarterSine[CIRCLE/2 - angle];
+  if (angle <= 3*CIRCLE/4) return -quarterSine[angle - CIRCLE/2];
+  return -quarterSine[CIRCLE - angle];
+}
+
+// Q15 cosine of angle
+static int32_t cosine(uint32_t angle){
+  return sine(angle + CIRCLE/4);
+}
+
+/*
+===================================================================================================
+  FFT :: FFT_ValidSize
+  
+   - return true if points is a power of 2 the FFT handles
+===================================================================================================
+*/
+bool FFT_ValidSize(uint32_t points){
+  return points >= FFT_MIN_POINTS && points <= FFT_MAX_POINTS && (points & (points - 1)) == 0;
+}
+
+/*
+===================================================================================================
+  FFT :: FFT_Load
+  
+   - maps the code range of bits onto Q15 -1..1 and multiplies by the window
+===================================================================================================
+*/
+void FFT_Load(int16_t* data, const uint16_t* samples, uint32_t points, unsigned int bits, uint8_t window){
+  int shift = 16 - bits;
+  uint32_t step = CIRCLE / points;          // window angle per sample, one period over the block
+  for (uint32_t n = 0; n < points; n++){
+    int32_t x = ((int32_t)samples[n] << shift) - 32768;
+    int32_t c = cosine(n * step);
+    switch (window){
+      case FFT_HANN:                        // 0.5 - 0.5 cos
+        x = (x * (16384 - c/2)) >> 15;
+        break;
+      case FFT_HAMMING:                     // 0.54 - 0.46 cos
+        x = (x * (17695 - ((c * 15073) >> 15))) >> 15;
+        break;
+    }
+    data[n] = (int16_t)x;
+  }
+}
+
+/*
+===================================================================================================
+  FFT :: complexFFT
+  
+   - radix-2 decimation in time FFT of count interleaved complex Q15 values, in place, every
+     stage halves its results
+===================================================================================================
+*/
+static void complexFFT(int16_t* data, uint32_t count){
+  // bit reversed order
+  for (uint32_t i = 1, j = 0; i < count; i++){
+    uint32_t bit = count >> 1;
+    for (; j & bit; bit >>= 1){
+      j ^= bit;
+    }
+    j |= bit;
+    if (i < j){
+      int16_t swap = data[2*i];
+      data[2*i] = data[2*j];
+      data[2*j] = swap;
+      swap = data[2*i + 1];
+      data[2*i + 1] = data[2*j + 1];
+      data[2*j + 1] = swap;
+    }
+  }
+  
+  // butterflies, W = cos - j sin
+  for (uint32_t length = 2; length <= count; length <<= 1){
+    uint32_t half = length >> 1;
+    uint32_t step = CIRCLE / length;
+    for (uint32_t k = 0; k < half; k++){
+      int32_t wr = cosine(k * step);
+      int32_t wi = -sine(k * step);
+      for (uint32_t p = k; p < count; p += length){
+        int16_t* a = &data[2*p];
+        int16_t* b = &data[2*(p + half)];
+        int32_t tr = (wr * b[0] - wi * b[1]) >> 15;
+        int32_t ti = (wr * b[1] + wi * b[0]) >> 15;
+        b[0] = (int16_t)((a[0] - tr) >> 1);
+        b[1] = (int16_t)((a[1] - ti) >> 1);
+        a[0] = (int16_t)((a[0] + tr) >> 1);
+        a[1] = (int16_t)((a[1] + ti) >> 1);
+      }
+    }
+  }
+}
+
+/*
+===================================================================================================
+  FFT :: FFT_Real
+  
+   - real FFT through a half size complex FFT: the even samples are the real parts and the odd
+     ones the imaginary parts, then each bin pair k, N/2-k is split into the even and odd
+     sample spectra and recombined with the twiddle W^k
+===================================================================================================
+*/
+void FFT_Real(int16_t* data, uint32_t points){
+  uint32_t count = points / 2;
+  uint32_t step = CIRCLE / points;
+  complexFFT(data, count);
+  
+  // DC and Nyquist are both real, they share the first pair
+  int32_t r0 = data[0];
+  int32_t i0 = data[1];
+  data[0] = (int16_t)((r0 + i0) >> 1);
+  data[1] = (int16_t)((r0 - i0) >> 1);
+  
+  for (uint32_t k = 1; k <= count / 2; k++){
+    int16_t* a = &data[2*k];
+    int16_t* b = &data[2*(count - k)];
+    
+    // even spectrum E = (Z[k] + conj Z[M-k]) / 2, odd spectrum O = -j (Z[k] - conj Z[M-k]) / 2
+    int32_t evenRe = (a[0] + b[0]) >> 1;
+    int32_t evenIm = (a[1] - b[1]) >> 1;
+    int32_t oddRe = (a[1] + b[1]) >> 1;
+    int32_t oddIm = (b[0] - a[0]) >> 1;
+    
+    // W^k O, W = cos - j sin
+    int32_t wr = cosine(k * step);
+    int32_t wi = -sine(k * step);
+    int32_t tr = (wr * oddRe - wi * oddIm) >> 15;
+    int32_t ti = (wr * oddIm + wi * oddRe) >> 15;
+    
+    // X[k] = E + W^k O, X[M-k] = conj(E - W^k O), halved once more for headroom
+    a[0] = (int16_t)((evenRe + tr) >> 1);
+    a[1] = (int16_t)((evenIm + ti) >> 1);
+    if (a != b){
+      b[0] = (int16_t)((evenRe - tr) >> 1);
+      b[1] = (int16_t)((ti - evenIm) >> 1);
+    }
+  }
+}
+
+/*
+===================================================================================================
+  FFT :: FFT_SquareRoot
+  
+   - integer square root, bit by bit
+===================================================================================================
+*/
+uint32_t FFT_SquareRoot(uint32_t value){
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > value){
+    bit >>= 2;
+  }
+  while (bit != 0){
+    if (value >= root + bit){
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+/*
+===================================================================================================
+  FFT :: FFT_Magnitude
+  
+   - bin k's magnitude goes to element k, which is never ahead of the pair being read, every
+     bin but DC doubles to count its negative frequency twin
+===================================================================================================
+*/
+void FFT_Magnitude(int16_t* data, uint32_t points){
+  uint16_t* magnitude = (uint16_t*)data;
+  int32_t dc = data[0];
+  magnitude[0] = (uint16_t)((dc < 0) ? -dc : dc);
+  for (uint32_t k = 1; k < points / 2; k++){
+    int32_t re = data[2*k];
+    int32_t im = data[2*k + 1];
+    uint32_t m = 2 * FFT_SquareRoot((uint32_t)(re * re) + (uint32_t)(im * im));
+    magnitude[k] = (uint16_t)((m > 32767) ? 32767 : m);
+  }
+}
+
+/*
+===================================================================================================
+  FFT :: FFT_Decibels
+  
+   - 20 log10(magnitude / 32768) in tenths of a dB, from a fixed point log2: the integer part
+     is the top bit, each fraction bit comes from squaring the mantissa
+===================================================================================================
+*/
+int32_t FFT_Decibels(uint16_t magnitude){
+  if (magnitude == 0){
+    return FFT_DB_FLOOR;
+  }
+  int32_t log2 = 15;                        // integer part, mantissa normalized to 1.15
+  uint32_t mantissa = magnitude;
+  while (mantissa < 32768){
+    mantissa <<= 1;
+    log2--;
+  }
+  int32_t fraction = 0;                     // 8 fraction bits
+  for (int bit = 0; bit < 8; bit++){
+    mantissa = (mantissa * mantissa) >> 15;
+    fraction <<= 1;
+    if (mantissa >= 65536){
+      mantissa >>= 1;
+      fraction |= 1;
+    }
+  }
+  
+  // 20 log10(2) = 6.0206 dB per octave below 2^15
+  int32_t log2Q8 = ((log2 - 15) << 8) + fraction;
+  return (log2Q8 * 602 - 128) / 2560;
+}
@@ -0,0 +1,49 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Fixed-point real FFT, in place on Q15 samples. N real samples (N a power of 2 from
+// FFT_MIN_POINTS to FFT_MAX_POINTS) are packed as N/2 complex values, run through a radix-2
+// complex FFT and split into the N/2 positive frequency bins. Every stage halves its results so
+// nothing overflows, the output is the true transform divided by N.
+//
+// Output layout, int16 pairs: data[0] DC, data[1] the N/2 (Nyquist) bin, both real, then
+// data[2k], data[2k+1] real and imaginary of bin k for k = 1 to N/2 - 1.
+//
+// Typical use on a capture:
+//    FFT_Load(data, samples, N, bits, FFT_HANN);
+//    FFT_Real(data, N);
+//    FFT_Magnitude(data, N);      // data now holds N/2 magnitudes
+
+#define FFT_MIN_POINTS 16
+#define FFT_MAX_POINTS 1024
+
+// windows
+#define FFT_RECTANGLE 0
+#define FFT_HANN      1
+#define FFT_HAMMING   2
+
+#define FFT_DB_FLOOR  (-999)            // FFT_Decibels of a zero magnitude, tenths of a dB
+
+// returns true if points is a supported FFT size
+bool FFT_ValidSize(uint32_t points);
+
+// converts points samples of bits (12-16) to Q15 with the window applied
+void FFT_Load(int16_t* data, const uint16_t* samples, uint32_t points, unsigned int bits, uint8_t window);
+
+// in place real FFT of points Q15 values, see the layout above
+void FFT_Real(int16_t* data, uint32_t points);
+
+// replaces the FFT output with points/2 single sided magnitudes, in place: a full scale sine
+// in a bin reads 32767 with the rectangle window (half that with Hann, 0.54 with Hamming)
+void FFT_Magnitude(int16_t* data, uint32_t points);
+
+// magnitude in tenths of a dB below full scale (32768), FFT_DB_FLOOR for 0
+int32_t FFT_Decibels(uint16_t magnitude);
+
+// integer square root, rounded down (also used by stats.c)
+uint32_t FFT_SquareRoot(uint32_t value);
+
+#endif
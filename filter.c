@@ -0,0 +1,331 @@
+#include "filter.h"
+#include "defs.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// prototypes for functions defined in startup.s
+long StartCritical (void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
+
+// ARMCC on a Cortex-M4 has the DSP extension intrinsics
+#if defined(__ARMCC_VERSION) && defined(__TARGET_FEATURE_DSPMUL)
+#define FILTER_SMLAD 1
+#endif
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+#define CHUNK_SIZE 128        // samples converted and filtered per pass over the stages
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+FILTER_Config FILTER_Settings = { {0}, 0, {{0}}, 0, 1, 1 };
+
+// FIR taps newest last, so they line up with the sample window in memory, padded to a pair
+static int16_t firReversed[FILTER_MAX_TAPS] __attribute__((aligned(4)));
+static uint8_t firPairs;
+
+// FIR window: the last taps-1 samples of the previous chunk, then this chunk
+static int16_t firWindow[FILTER_MAX_TAPS + CHUNK_SIZE];
+
+// moving average ring and its running sum
+static int16_t averageRing[FILTER_MAX_AVERAGE];
+static uint8_t averageIndex;
+static int32_t averageSum;
+
+// biquad delay lines, x[n-1], x[n-2], y[n-1], y[n-2] per stage
+static int16_t biquadState[FILTER_MAX_BIQUADS][4];
+
+// decimation phase, outputs to drop before the next kept one
+static uint8_t decimatePhase;
+
+/*
+========================================================================================================================
+==========                                          FILTER FUNCTIONS                                          ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  FILTER :: saturate
+  
+   - clamps to the Q15 range
+===================================================================================================
+*/
+static int16_t saturate(int32_t value){
+  if (value > 32767) return 32767;
+  if (value < -32768) return -32768;
+  return (int16_t)value;
+}
+
+/*
+===================================================================================================
+  FILTER :: FILTER_Reset
+  
+   - clears every delay line, the next sample starts a new signal
+===================================================================================================
+*/
+void FILTER_Reset(void){
+  long sr = StartCritical();              // the stream consumer filters from the ADC interrupt
+  memset(firWindow, 0, sizeof(firWindow));
+  memset(averageRing, 0, sizeof(averageRing));
+  memset(biquadState, 0, sizeof(biquadState));
+  averageIndex = 0;
+  averageSum = 0;
+  decimatePhase = 0;
+  
+  // reversed taps for the kernel, an odd count gets a zero tap in front (the oldest sample)
+  firPairs = (FILTER_Settings.numTaps + 1) / 2;
+  memset(firReversed, 0, sizeof(firReversed));
+  for (int i = 0; i < FILTER_Settings.numTaps; i++){
+    firReversed[firPairs*2 - 1 - i] = FILTER_Settings.taps[i];
+  }
+  EndCritical(sr);
+}
+
+/*
+===================================================================================================
+  FILTER :: FILTER_SetTaps
+  
+   - writes count FIR taps from tap first on, writing from tap 0 starts a new set
+   - return success value
+===================================================================================================
+*/
+int FILTER_SetTaps(uint8_t first, const int16_t* taps, uint8_t count){
+  if (first > FILTER_Settings.numTaps || first + count > FILTER_MAX_TAPS){
+    return CMD_FAILURE;
+  }
+  long sr = StartCritical();
+  memcpy(&FILTER_Settings.taps[first], taps, count * sizeof(int16_t));
+  if (first == 0 || first + count > FILTER_Settings.numTaps){
+    FILTER_Settings.numTaps = first + count;
+  }
+  EndCritical(sr);
+  FILTER_Reset();
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  FILTER :: FILTER_SetBiquad
+  
+   - replaces a stage of the cascade, or appends one when stage is the stage count
+   - return success value
+===================================================================================================
+*/
+int FILTER_SetBiquad(uint8_t stage, const FILTER_Biquad* biquad){
+  if (stage > FILTER_Settings.numBiquads || stage >= FILTER_MAX_BIQUADS){
+    return CMD_FAILURE;
+  }
+  long sr = StartCritical();
+  FILTER_Settings.biquads[stage] = *biquad;
+  if (stage == FILTER_Settings.numBiquads){
+    FILTER_Settings.numBiquads++;
+  }
+  EndCritical(sr);
+  FILTER_Reset();
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  FILTER :: FILTER_SetAverage
+  
+   - sets the moving average length, 1 turns it off
+   - return success value
+===================================================================================================
+*/
+int FILTER_SetAverage(uint8_t length){
+  if (length < 1 || length > FILTER_MAX_AVERAGE){
+    return CMD_FAILURE;
+  }
+  FILTER_Settings.average = length;
+  FILTER_Reset();
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  FILTER :: FILTER_SetDecimate
+  
+   - keeps one of every factor filtered samples, 1 keeps them all
+   - return success value
+===================================================================================================
+*/
+int FILTER_SetDecimate(uint8_t factor){
+  if (factor < 1 || factor > FILTER_MAX_DECIMATE){
+    return CMD_FAILURE;
+  }
+  FILTER_Settings.decimate = factor;
+  FILTER_Reset();
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  FILTER :: FILTER_Clear
+  
+   - turns every stage into a pass-through
+===================================================================================================
+*/
+void FILTER_Clear(void){
+  long sr = StartCritical();
+  FILTER_Settings.numTaps = 0;
+  FILTER_Settings.numBiquads = 0;
+  FILTER_Settings.average = 1;
+  FILTER_Settings.decimate = 1;
+  EndCritical(sr);
+  FILTER_Reset();
+}
+
+/*
+===================================================================================================
+  FILTER :: FILTER_Enabled
+  
+   - return true if any stage changes the samples
+===================================================================================================
+*/
+bool FILTER_Enabled(void){
+  return FILTER_Settings.numTaps > 0 || FILTER_Settings.numBiquads > 0 ||
+         FILTER_Settings.average > 1 || FILTER_Settings.decimate > 1;
+}
+
+/*
+===================================================================================================
+  FILTER :: average
+  
+   - moving average over the last FILTER_Settings.average samples, in place
+===================================================================================================
+*/
+static void average(int16_t* x, uint32_t length){
+  uint8_t size = FILTER_Settings.average;
+  for (uint32_t n = 0; n < length; n++){
+    averageSum += x[n] - averageRing[averageIndex];
+    averageRing[averageIndex] = x[n];
+    if (++averageIndex == size){
+      averageIndex = 0;
+    }
+    x[n] = (int16_t)(averageSum / size);
+  }
+}
+
+#ifdef FILTER_SMLAD
+/*
+===================================================================================================
+  FILTER :: pair
+  
+   - loads two neighbouring Q15 values as one word for the SIMD instructions, the window
+     position isn't always word aligned (the M4 allows unaligned LDR)
+===================================================================================================
+*/
+static __inline int32_t pair(const int16_t* p){
+  return *(__packed const int32_t*)p;
+}
+#endif
+
+/*
+===================================================================================================
+  FILTER :: fir
+  
+   - FIR over a chunk, in place: y[n] = sum taps[k] x[n-k], Q15 with a 64 bit accumulator, as
+     taps summing to 2 or more in magnitude already overflow 32 bits on a full scale input
+   - on a Cortex-M4 SMLALD does two multiply-accumulates per instruction on halfword pairs
+===================================================================================================
+*/
+static void fir(int16_t* x, uint32_t length){
+  uint32_t span = firPairs * 2;           // taps rounded up to a pair
+  int16_t* window = &firWindow[FILTER_MAX_TAPS - span + 1];
+  
+  // window[0..span-2] is history, append the chunk behind it
+  memcpy(&firWindow[FILTER_MAX_TAPS], x, length * sizeof(int16_t));
+  
+  for (uint32_t n = 0; n < length; n++){
+    const int16_t* w = &window[n];
+    int64_t acc = 0;
+#ifdef FILTER_SMLAD
+    const int32_t* c = (const int32_t*)firReversed;
+    for (uint32_t k = 0; k < firPairs; k++){
+      acc = __smlald(pair(&w[2*k]), c[k], acc);
+    }
+#else
+    for (uint32_t k = 0; k < span; k++){
+      acc += (int32_t)w[k] * firReversed[k];
+    }
+#endif
+    x[n] = saturate((int32_t)(acc >> 15));     // at most 64 taps of 2^30, under 2^21 once shifted
+  }
+  
+  // keep the newest span-1 samples as history for the next chunk
+  memmove(&firWindow[FILTER_MAX_TAPS - span + 1], &firWindow[FILTER_MAX_TAPS + length - span + 1],
+          (span - 1) * sizeof(int16_t));
+}
+
+/*
+===================================================================================================
+  FILTER :: biquads
+  
+   - runs a chunk through the biquad cascade in place, direct form I, with a 64-bit accumulator
+===================================================================================================
+*/
+static void biquads(int16_t* x, uint32_t length){
+  for (int s = 0; s < FILTER_Settings.numBiquads; s++){
+    const FILTER_Biquad* c = &FILTER_Settings.biquads[s];
+    int16_t* state = biquadState[s];
+    for (uint32_t n = 0; n < length; n++){
+      // each Q2.14 x Q15 product is under 2^31, five of them are not (SMLAL keeps this cheap)
+      int64_t acc = (int64_t)c->b0 * x[n] + (int64_t)c->b1 * state[0] + (int64_t)c->b2 * state[1] -
+                    (int64_t)c->a1 * state[2] - (int64_t)c->a2 * state[3];
+      int16_t y = saturate((int32_t)(acc >> FILTER_BIQUAD_SHIFT));
+      state[1] = state[0];
+      state[0] = x[n];
+      state[3] = state[2];
+      state[2] = y;
+      x[n] = y;
+    }
+  }
+}
+
+/*
+===================================================================================================
+  FILTER :: FILTER_Block
+  
+   - runs samples of 12 to 16 bits through every enabled stage in place, CHUNK_SIZE at a time
+   - return the number of samples left at the front of the block after decimation
+===================================================================================================
+*/
+uint32_t FILTER_Block(uint16_t* samples, uint32_t length, unsigned int bits){
+  static int16_t chunk[CHUNK_SIZE];
+  uint32_t kept = 0;
+  int shift = 16 - bits;                  // code to Q15 scale
+  
+  for (uint32_t done = 0; done < length; done += CHUNK_SIZE){
+    uint32_t count = (length - done < CHUNK_SIZE) ? length - done : CHUNK_SIZE;
+    for (uint32_t i = 0; i < count; i++){
+      chunk[i] = (int16_t)(((int32_t)samples[done + i] << shift) - 32768);
+    }
+    
+    if (FILTER_Settings.average > 1) average(chunk, count);
+    if (FILTER_Settings.numTaps > 0) fir(chunk, count);
+    if (FILTER_Settings.numBiquads > 0) biquads(chunk, count);
+    
+    // back to codes, kept samples pack toward the front (never ahead of the ones read)
+    for (uint32_t i = 0; i < count; i++){
+      if (decimatePhase == 0){
+        samples[kept++] = (uint16_t)((chunk[i] + 32768) >> shift);
+      }
+      if (++decimatePhase == FILTER_Settings.decimate){
+        decimatePhase = 0;
+      }
+    }
+  }
+  return kept;
+}
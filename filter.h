@@ -0,0 +1,54 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Filter pipeline for one channel of samples, run block by block as captures and stream blocks
+// complete. Samples become Q15 (the code range mapped onto -1..1) and go through, in order:
+//   moving average  ->  FIR (Q15 taps)  ->  biquad cascade (Q2.14)  ->  decimation
+// then back to codes, in place. A stage is skipped while it is a pass-through (average of
+// 1, no taps, no biquads, decimation of 1). State carries over from block to block until
+// FILTER_Reset, so a stream is filtered as one signal.
+//
+// On a Cortex-M4 the FIR runs two taps per SMLALD, with a plain C kernel for other targets. Both
+// accumulate in 64 bits, so any set of taps is accepted and the output saturates.
+
+#define FILTER_MAX_TAPS     64        // even, the SMLALD kernel takes taps in pairs
+#define FILTER_MAX_BIQUADS  4
+#define FILTER_MAX_AVERAGE  64
+#define FILTER_MAX_DECIMATE 64
+#define FILTER_BIQUAD_SHIFT 14        // biquad coefficients are Q2.14, so |a1| < 2 fits
+#define FILTER_BIQUAD_ONE   (1 << FILTER_BIQUAD_SHIFT)
+
+// y = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2], all Q2.14
+typedef struct {
+  int16_t b0, b1, b2, a1, a2;
+} FILTER_Biquad;
+
+typedef struct {
+  int16_t taps[FILTER_MAX_TAPS];      // Q15, taps[0] multiplies the newest sample
+  uint8_t numTaps;
+  FILTER_Biquad biquads[FILTER_MAX_BIQUADS];
+  uint8_t numBiquads;
+  uint8_t average;                    // moving average length, 1 is off
+  uint8_t decimate;                   // keep every decimate-th output, 1 is off
+} FILTER_Config;
+
+extern FILTER_Config FILTER_Settings;
+
+// configuration, return success value, every change also resets the filter state
+int FILTER_SetTaps(uint8_t first, const int16_t* taps, uint8_t count);
+int FILTER_SetBiquad(uint8_t stage, const FILTER_Biquad* biquad);
+int FILTER_SetAverage(uint8_t length);
+int FILTER_SetDecimate(uint8_t factor);
+void FILTER_Clear(void);              // every stage back to a pass-through
+
+bool FILTER_Enabled(void);
+void FILTER_Reset(void);              // forgets the signal history
+
+// filters length samples of bits (12-16, see ADC_SampleBits) in place, returns how many are
+// left after decimation
+uint32_t FILTER_Block(uint16_t* samples, uint32_t length, unsigned int bits);
+
+#endif
@@ -0,0 +1,235 @@
+#include "frame.h"
+#include "usb_uart.h"
+#include "defs.h"
+#include "log.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+#define FRAME_PACKET_SIZE (FRAME_MAX_PAYLOAD + FRAME_OVERHEAD)
+
+// CRC-16/CCITT (poly 0x1021) remainders of every 4 bit value, processed a nibble at a time
+static const uint16_t crcNibbleTable[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+// number of received frames rejected for bad COBS encoding, length or crc
+uint32_t FRAME_BadFrames = 0;
+
+// where FRAME_Send puts unsolicited frames, responses always go back over the shell port
+UART_Port* FRAME_TelemetryPort = &UART_Ports[0];
+
+// transmit scratch buffers, frames are only sent from the main loop
+static uint8_t txPacket[FRAME_PACKET_SIZE];
+static uint8_t txEncoded[USB_FRAME_SIZE];
+
+/*
+========================================================================================================================
+==========                                          FRAME FUNCTIONS                                           ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  FRAME :: FRAME_Crc16
+
+   - CRC-16/CCITT over a buffer, continuing from crc (start with 0xFFFF)
+===================================================================================================
+*/
+uint16_t FRAME_Crc16(uint16_t crc, const uint8_t* data, uint32_t length){
+  for (uint32_t i = 0; i < length; i++){
+    crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (data[i] >> 4)]);
+    crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (data[i] & 0x0F)]);
+  }
+  return crc;
+}
+
+/*
+===================================================================================================
+  FRAME :: FRAME_CobsEncode
+
+   - COBS encodes length bytes of input, output needs length + length/254 + 1 bytes
+   - returns number of encoded bytes
+===================================================================================================
+*/
+uint32_t FRAME_CobsEncode(const uint8_t* input, uint32_t length, uint8_t* output){
+  uint32_t readIndex = 0;
+  uint32_t writeIndex = 1;
+  uint32_t codeIndex = 0;
+  uint8_t code = 1;
+
+  while (readIndex < length){
+    if (input[readIndex] == 0){
+      output[codeIndex] = code;                     // close the block at the zero
+      code = 1;
+      codeIndex = writeIndex++;
+      readIndex++;
+    } else {
+      output[writeIndex++] = input[readIndex++];
+      code++;
+      if (code == 0xFF){                            // block full, start another
+        output[codeIndex] = code;
+        code = 1;
+        codeIndex = writeIndex++;
+      }
+    }
+  }
+  output[codeIndex] = code;
+  return writeIndex;
+}
+
+/*
+===================================================================================================
+  FRAME :: FRAME_CobsDecode
+
+   - decodes a COBS block (without delimiters), may be done in place (output == input)
+   - returns number of decoded bytes, 0 if the encoding is malformed
+===================================================================================================
+*/
+uint32_t FRAME_CobsDecode(const uint8_t* input, uint32_t length, uint8_t* output){
+  uint32_t readIndex = 0;
+  uint32_t writeIndex = 0;
+
+  while (readIndex < length){
+    uint8_t code = input[readIndex];
+    if (code == 0 || readIndex + code > length){
+      return 0;                                     // zero inside a frame or block runs off the end
+    }
+    readIndex++;
+    for (uint8_t i = 1; i < code; i++){
+      output[writeIndex++] = input[readIndex++];
+    }
+    if (code != 0xFF && readIndex != length){
+      output[writeIndex++] = 0;                     // block ended on a zero
+    }
+  }
+  return writeIndex;
+}
+
+/*
+===================================================================================================
+  FRAME :: FRAME_Transmit
+
+   - assembles a packet from a header part and a data part, then encodes and sends it on a port
+===================================================================================================
+*/
+static int FRAME_Transmit(UART_Port* port, uint8_t type, const uint8_t* head, uint16_t headLength,
+                          const uint8_t* data, uint16_t length){
+  uint32_t payloadLength = headLength + length;
+  if (payloadLength > FRAME_MAX_PAYLOAD){
+    return CMD_FAILURE;
+  }
+
+  txPacket[0] = type;
+  txPacket[1] = (uint8_t)payloadLength;
+  if (headLength > 0) memcpy(&txPacket[2], head, headLength);
+  if (length > 0) memcpy(&txPacket[2 + headLength], data, length);
+  FRAME_WriteU16(&txPacket[2 + payloadLength], FRAME_Crc16(0xFFFF, txPacket, 2 + payloadLength));
+
+  uint32_t encodedLength = FRAME_CobsEncode(txPacket, payloadLength + FRAME_OVERHEAD, txEncoded);
+
+  UART_PutChar(port, 0);                            // leading delimiter
+  UART_Write(port, txEncoded, encodedLength);
+  UART_PutChar(port, 0);                            // trailing delimiter
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  FRAME :: FRAME_Send
+
+   - encodes and sends a frame of the given type on the telemetry port
+   - return success value
+===================================================================================================
+*/
+int FRAME_Send(uint8_t type, const uint8_t* payload, uint16_t length){
+  return FRAME_Transmit(FRAME_TelemetryPort, type, NULL, 0, payload, length);
+}
+
+/*
+===================================================================================================
+  FRAME :: FRAME_Respond
+
+   - sends the response to a request: the status byte followed by optional data
+   - return success value
+===================================================================================================
+*/
+int FRAME_Respond(uint8_t type, uint8_t status, const uint8_t* data, uint16_t length){
+  return FRAME_Transmit(USB_UART_Port, type | FRAME_RESPONSE, &status, 1, data, length);
+}
+
+/*
+===================================================================================================
+  FRAME :: FRAME_HandleFrame
+
+   - decodes a frame collected by the UART in place, checks length and crc, and attempts to
+     locate an associated handler in frameCommands
+===================================================================================================
+*/
+void FRAME_HandleFrame(USB_Frame* frame){
+  uint8_t* packet = frame->data;
+  uint32_t length = FRAME_CobsDecode(frame->data, frame->length, packet);
+
+  // verify framing
+  if (length < FRAME_OVERHEAD || length != (uint32_t)packet[1] + FRAME_OVERHEAD){
+    FRAME_BadFrames++;
+    LOG_WARN(FRAME, "bad frame length %d", length);
+    return;
+  }
+  uint8_t type = packet[0];
+  uint8_t payloadLength = packet[1];
+  if (FRAME_Crc16(0xFFFF, packet, 2 + payloadLength) != FRAME_ReadU16(&packet[2 + payloadLength])){
+    FRAME_BadFrames++;
+    LOG_WARN(FRAME, "bad crc on frame type 0x%02x", type);
+    return;
+  }
+
+  // frameCommands[] array is pre-defined in command.c
+  for (int i = 0; frameCommands[i].function != NULL; i++){
+    if (frameCommands[i].type == type){
+      frameCommands[i].function(&packet[2], payloadLength);
+      return;
+    }
+  }
+  LOG_INFO(FRAME, "no handler for frame type 0x%02x", type);
+  FRAME_Respond(type, CMD_FAILURE, NULL, 0);
+}
+
+/*
+===================================================================================================
+  FRAME :: little endian field helpers
+===================================================================================================
+*/
+uint32_t FRAME_ReadU32(const uint8_t* data){
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+uint16_t FRAME_ReadU16(const uint8_t* data){
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+void FRAME_WriteU32(uint8_t* data, uint32_t value){
+  data[0] = (uint8_t)value;
+  data[1] = (uint8_t)(value >> 8);
+  data[2] = (uint8_t)(value >> 16);
+  data[3] = (uint8_t)(value >> 24);
+}
+
+void FRAME_WriteU16(uint8_t* data, uint16_t value){
+  data[0] = (uint8_t)value;
+  data[1] = (uint8_t)(value >> 8);
+}
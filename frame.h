@@ -0,0 +1,82 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "usb_uart.h"
+
+// Binary command/telemetry framing used alongside the text shell (see usb_uart.h).
+//
+// On the wire every frame is COBS encoded and wrapped in NUL delimiters:
+//   0x00 [COBS encoded packet] 0x00
+// The decoded packet is:
+//   [type:1] [length:1] [payload:length] [crc16:2]
+// crc16 is CRC-16/CCITT (poly 0x1021, init 0xFFFF) over type, length and payload,
+// sent little endian. All multi-byte payload fields are little endian.
+//
+// Every request is answered with a frame of type (request type | FRAME_RESPONSE) whose first
+// payload byte is CMD_SUCCESS or CMD_FAILURE, followed by any response data.
+
+#define FRAME_MAX_PAYLOAD 255
+#define FRAME_OVERHEAD    4          // type, length and crc16
+#define FRAME_RESPONSE    0x80       // set in the type of every frame sent by the board
+
+// frame types (requests from the host)
+#define FRAME_PING        0x01       // echoes the payload back
+#define FRAME_SET         0x02       // [param:1] [value:4]
+#define FRAME_GET         0x03       // [param:1] -> [value:4]
+#define FRAME_RUN         0x04       // [command:1] [arguments...]
+#define FRAME_SAMPLES     0x05       // [offset:4] [count:1] -> [samples:2*count] from the last capture
+#define FRAME_PACKED      0x06       // [offset:4] [count:2] [mode:1] -> [chunk] up to count samples from
+                                     // the last capture, compressed (see pack.h)
+#define FRAME_INFO        0x07       // -> [startMs:4] [startCycles:4] [periodCycles:4] [sampleCycles:4]
+                                     // [rateMilliHz:4] [requestedHz:4] [samples:4] [channel:1]
+                                     // [channels:1] [bits:1] [flags:1] of the last capture (see adc.h)
+
+// parameter ids for FRAME_SET/FRAME_GET
+#define FRAME_PARAM_PWM_FREQ  0x01
+#define FRAME_PARAM_PWM_DUTY  0x02
+#define FRAME_PARAM_ADC_STATUS 0x03
+
+// command ids for FRAME_RUN
+#define FRAME_RUN_ADC_COLLECT 0x01   // [channel:1] [frequency:2] [numSamples:2] -> [reason:1] [job:1]
+
+// defines frame handler function signature
+typedef int (*frameFunc)(uint8_t* payload, uint8_t length);
+
+// frame command data structure definition, the binary counterpart of Command
+typedef struct {
+    uint8_t type;                   // frame type used to identify command
+    frameFunc function;             // pointer to function that handles command execution
+    char* helpText;                 // describes the payload layout
+} FrameCommand;
+
+extern FrameCommand frameCommands[];
+extern uint32_t FRAME_BadFrames;
+extern UART_Port* FRAME_TelemetryPort;
+
+// decodes, checks and dispatches a frame received by the UART
+void FRAME_HandleFrame(USB_Frame* frame);
+
+// encodes and sends a frame of the given type on FRAME_TelemetryPort (the shell port unless
+// moved with "set telemetryPort"), returns CMD_FAILURE if the payload is too long
+int FRAME_Send(uint8_t type, const uint8_t* payload, uint16_t length);
+
+// sends a response frame on the shell port: the status byte followed by optional data
+int FRAME_Respond(uint8_t type, uint8_t status, const uint8_t* data, uint16_t length);
+
+// CRC-16/CCITT over a buffer, continuing from crc (start with 0xFFFF)
+uint16_t FRAME_Crc16(uint16_t crc, const uint8_t* data, uint32_t length);
+
+// COBS encode/decode, return output length (decode returns 0 on a malformed frame)
+uint32_t FRAME_CobsEncode(const uint8_t* input, uint32_t length, uint8_t* output);
+uint32_t FRAME_CobsDecode(const uint8_t* input, uint32_t length, uint8_t* output);
+
+// little endian field helpers
+uint32_t FRAME_ReadU32(const uint8_t* data);
+uint16_t FRAME_ReadU16(const uint8_t* data);
+void FRAME_WriteU32(uint8_t* data, uint32_t value);
+void FRAME_WriteU16(uint8_t* data, uint16_t value);
+
+#endif
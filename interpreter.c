@@ -3,6 +3,7 @@
 #include "command.h"
 #include "debug.h"
 #include "fifo.h"
+#include "script.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -12,80 +13,109 @@
 
 /*
 ========================================================================================================================
-==========                                             CONSTANTS                                              ==========
+==========                                       INTERPRETER FUNCTIONS                                        ==========
 ========================================================================================================================
 */
 
-#define BUFFER_SIZE 64
-#define MAX_TOKENS 16
-
 /*
-========================================================================================================================
-==========                                          GLOBAL VARIABLES                                          ==========
-========================================================================================================================
+===================================================================================================
+  INTERPRETER FUNCTION :: INTER_Tokenize
+  
+   - splits a null terminated line into tokens in place, no copy and no static state (unlike
+     strtok), so several lines may be tokenized at once from different contexts
+   - tokens are separated by spaces or tabs; double quotes group spaces into one token and are
+     removed, and inside quotes \" and \\ stand for a literal quote and backslash
+   - returns INTER_OK, or INTER_TOO_MANY / INTER_OPEN_QUOTE with the view holding the tokens
+     found so far
+===================================================================================================
 */
+int INTER_Tokenize(char* line, INTER_Tokens* view){
+  char* read = line;
+  view->count = 0;
 
-char INTER_CmdBuffer[BUFFER_SIZE];
+  while (1){
+    // skip separators up to the next token
+    while (*read == ' ' || *read == '\t'){
+      read++;
+    }
+    if (*read == 0){
+      return INTER_OK;
+    }
+    if (view->count >= INTER_MAX_TOKENS){
+      return INTER_TOO_MANY;
+    }
 
-/*
-========================================================================================================================
-==========                                       INTERPRETER FUNCTIONS                                        ==========
-========================================================================================================================
-*/
+    // copy the token down over any removed quotes, write never passes read
+    char* write = read;
+    bool quoted = false;
+    view->tokens[view->count++] = write;
+    while (*read != 0 && (quoted || (*read != ' ' && *read != '\t'))){
+      if (*read == '"'){
+        quoted = !quoted;
+        read++;
+        continue;
+      }
+      if (quoted && *read == '\\' && (read[1] == '"' || read[1] == '\\')){
+        read++;
+      }
+      *write++ = *read++;
+    }
+    if (quoted){
+      *write = 0;
+      return INTER_OPEN_QUOTE;
+    }
+    if (*read != 0){
+      read++;                                       // step over the separator before terminating
+    }
+    *write = 0;
+  }
+}
 
 /*
 ===================================================================================================
-  INTERPRETER FUNCTION :: INTER_HandleBuffer
+  INTERPRETER FUNCTION :: INTER_Execute
   
-   - grabs a null terminated string from the RxFifo, tokenizes it, and
-     attempts to locate an associated handler for a command
+   - tokenizes a null terminated line in place and attempts to locate and run an associated
+     handler for a command
+   - return success value of the handler (an empty line succeeds)
 ===================================================================================================
 */
-void INTER_HandleBuffer(void){
-    
-  char delim[] = " "; 
-  char* tokens[MAX_TOKENS];
-  char* tokenPtr;
-  int numTokens = 0;
-
-  int i = 0;
-  // retrieve buffer from fifo into INTER_CmdBuffer
-  do {
-    char letter;
-    RxFifo_Get(&letter);
-    INTER_CmdBuffer[i] = letter;
-  } while ( INTER_CmdBuffer[i++] != 0 && i < BUFFER_SIZE);
+int INTER_Execute(char* line){
+  INTER_Tokens view;
 
+  // break line into tokens
+  int status = INTER_Tokenize(line, &view);
+  if (status == INTER_TOO_MANY){
+    printf("ERROR: Too many arguments (at most %d tokens).\n", INTER_MAX_TOKENS);
+    return CMD_FAILURE;
+  }
+  if (status == INTER_OPEN_QUOTE){
+    printf("ERROR: Missing closing quote.\n");
+    return CMD_FAILURE;
+  }
   
-  // break buffer into tokens
-  tokenPtr = strtok(INTER_CmdBuffer, delim);
-  while ( tokenPtr != NULL ){
-    tokens[numTokens++] = tokenPtr;  // numTokens is post-incremented after tokens[] is updated
-    tokenPtr = strtok(NULL, delim);  // In subsequent calls, strtok expects a null pointer
+  // nothing to do for an empty line
+  if (view.count == 0) return CMD_SUCCESS;
+
+  // mainCommands[] array is pre-defined in command.c and sorted by CMD_Init, the first token
+  // is the key, e.g. tokens[] points to 0) run 1) adcCollect 2) channel 3) freq 4) nSamples
+  Command* command = CMD_Lookup(mainCommands, CMD_MainCount, view.tokens[0]);
+  if (command == NULL){
+    printf ("ERROR: No matching command found.\n");
+    return CMD_FAILURE;
   }
-    
-//    printf("parsed tokens:\n");
-//    for (int i = 0; i < numTokens; i++){
-//        printf("%d - %s\n", i, tokens[i]); 
-//    }
+  return CMD_Execute(command, view.tokens, view.count, 1);
+}
 
-   i = 0;
-   bool cmdFound = false;
-   while (mainCommands[i].function != NULL){									//if function pointer is not NULL
-																															
-																															// mainCommands[] array is pre-defined in command.c
-        if (strcmp(tokens[0], mainCommands[i].key) == 0){     // check the first user token to key
-																															// example: tokens[] pointer array points to 
-																															// 0) adcCollect 1) channel 2) freq 3) nSamples
-																															// if token matches with the ith command
-																															// then execute the ith command's function using
-																														  // the token[1].  
-																															// mainCommands is a Command struct with a function pointer
-              mainCommands[i].function(tokens, numTokens); // '1' is the index which will be used by token
-					
-              cmdFound = true;								
-        }
-        i++;
-    }
-    if (!cmdFound) printf ("ERROR: No matching command found.\n");
+/*
+===================================================================================================
+  INTERPRETER FUNCTION :: INTER_HandleBuffer
+  
+   - takes a null terminated line handed over by the UART and runs it, unless a script is being
+     entered, in which case the line is stored in the script instead
+===================================================================================================
+*/
+void INTER_HandleBuffer(char* line){
+  if (SCRIPT_Capture(line)) return;
+  INTER_Execute(line);
 }
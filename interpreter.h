@@ -2,7 +2,23 @@
 #define INTER_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
-void INTER_HandleBuffer(void);
+#define INTER_MAX_TOKENS 16
+
+// INTER_Tokenize results
+#define INTER_OK         0
+#define INTER_TOO_MANY   1          // more than INTER_MAX_TOKENS tokens on the line
+#define INTER_OPEN_QUOTE 2          // a quoted token was never closed
+
+// bounded view of the tokens of one line, the pointers point into the line itself
+typedef struct {
+  char* tokens[INTER_MAX_TOKENS];
+  uint8_t count;
+} INTER_Tokens;
+
+int INTER_Tokenize(char* line, INTER_Tokens* view);
+int INTER_Execute(char* line);
+void INTER_HandleBuffer(char* line);
 
 #endif
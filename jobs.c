@@ -0,0 +1,219 @@
+#include "jobs.h"
+#include "usb_uart.h"
+#include "dprint.h"
+#include "defs.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// prototypes for functions defined in startup.s
+long StartCritical (void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
+void WaitForInterrupt(void);  // low power mode
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+static Job jobs[JOB_COUNT];
+
+// id handed to the next job, wraps from 255 back to 1
+static uint8_t nextId = 1;
+
+/*
+========================================================================================================================
+==========                                            JOB FUNCTIONS                                           ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  JOB :: JOB_StateName
+  
+   - returns the printable name of a job state
+===================================================================================================
+*/
+const char* JOB_StateName(uint8_t state){
+  switch (state){
+    case JOB_RUNNING: return "running";
+    case JOB_DONE:    return "done";
+    case JOB_FAILED:  return "failed";
+    case JOB_KILLED:  return "killed";
+  }
+  return "free";
+}
+
+/*
+===================================================================================================
+  JOB :: JOB_Start
+  
+   - registers running work, taking a free slot or else the slot of the oldest finished job
+   - returns the job id, or 0 if every slot holds a running job
+===================================================================================================
+*/
+uint8_t JOB_Start(const char* name, jobPoll poll, jobKill kill){
+  Job* slot = NULL;
+  for (int i = 0; i < JOB_COUNT; i++){
+    if (jobs[i].state == JOB_FREE){
+      slot = &jobs[i];
+      break;
+    }
+    // ids only grow, so the oldest finished job is the one furthest back from nextId
+    if (jobs[i].state != JOB_RUNNING &&
+        (slot == NULL || (uint8_t)(nextId - jobs[i].id) > (uint8_t)(nextId - slot->id))){
+      slot = &jobs[i];
+    }
+  }
+  if (slot == NULL){
+    return 0;
+  }
+  
+  slot->id = nextId;
+  slot->state = JOB_RUNNING;
+  slot->name = name;
+  slot->poll = poll;
+  slot->kill = kill;
+  
+  // skip ids still held by long running jobs after a wrap
+  do {
+    nextId = (nextId == 255) ? 1 : nextId + 1;
+  } while (JOB_Find(nextId) != NULL);
+  return slot->id;
+}
+
+/*
+===================================================================================================
+  JOB :: JOB_Find
+  
+   - returns the job with the given id, or NULL if it is not in the table (anymore)
+===================================================================================================
+*/
+Job* JOB_Find(uint8_t id){
+  for (int i = 0; i < JOB_COUNT; i++){
+    if (jobs[i].state != JOB_FREE && jobs[i].id == id){
+      return &jobs[i];
+    }
+  }
+  return NULL;
+}
+
+/*
+===================================================================================================
+  JOB :: JOB_Update
+  
+   - asks a running job how it is doing, returns true if it just finished
+===================================================================================================
+*/
+static bool JOB_Update(Job* job){
+  if (job->state != JOB_RUNNING){
+    return false;
+  }
+  int state = job->poll();
+  if (state == JOB_RUNNING){
+    return false;
+  }
+  job->state = (state == JOB_DONE) ? JOB_DONE : JOB_FAILED;
+  return true;
+}
+
+/*
+===================================================================================================
+  JOB :: JOB_Poll
+  
+   - called by the main loop, reports every job that finished since the last call
+===================================================================================================
+*/
+void JOB_Poll(void){
+  for (int i = 0; i < JOB_COUNT; i++){
+    if (JOB_Update(&jobs[i])){
+      printf("[%d] %s %s\n", jobs[i].id, jobs[i].name, JOB_StateName(jobs[i].state));
+    }
+  }
+}
+
+/*
+===================================================================================================
+  JOB :: JOB_List
+  
+   - prints every job in the table, oldest first
+===================================================================================================
+*/
+void JOB_List(void){
+  bool any = false;
+  for (uint8_t age = 255; age > 0; age--){
+    uint8_t id = nextId - age;
+    Job* job = (id == 0) ? NULL : JOB_Find(id);
+    if (job != NULL){
+      JOB_Update(job);
+      printf("  [%d] %-12s %s\n", job->id, job->name, JOB_StateName(job->state));
+      any = true;
+    }
+  }
+  if (!any){
+    printf("  no jobs\n");
+  }
+  printf("\n");
+}
+
+/*
+===================================================================================================
+  JOB :: JOB_Kill
+  
+   - stops a running job
+   - return success value
+===================================================================================================
+*/
+int JOB_Kill(uint8_t id){
+  Job* job = JOB_Find(id);
+  if (job == NULL){
+    printf("ERROR: No job %d!\n\n", id);
+    return CMD_FAILURE;
+  }
+  if (JOB_Update(job) || job->state != JOB_RUNNING){
+    printf("  [%d] %s already %s\n\n", job->id, job->name, JOB_StateName(job->state));
+    return CMD_SUCCESS;
+  }
+  job->kill();
+  job->state = JOB_KILLED;
+  printf("  [%d] %s killed\n\n", job->id, job->name);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  JOB :: JOB_Wait
+  
+   - sleeps until a job finishes, still flushing deferred output
+   - a new shell line or frame ends the wait early so the shell never locks up behind a job
+   - return success value (failure if the job failed, was killed or is still running)
+===================================================================================================
+*/
+int JOB_Wait(uint8_t id){
+  Job* job = JOB_Find(id);
+  if (job == NULL){
+    printf("ERROR: No job %d!\n\n", id);
+    return CMD_FAILURE;
+  }
+  
+  while (!JOB_Update(job) && job->state == JOB_RUNNING){
+    if (USB_BufferReady){
+      printf("  [%d] %s still running\n\n", job->id, job->name);
+      return CMD_FAILURE;
+    }
+    DPRINT_Flush();
+    
+    // sleep with interrupts masked so a job finishing between the check and the sleep still
+    // wakes us up
+    long sr = StartCritical();
+    if (job->poll() == JOB_RUNNING && !USB_BufferReady){
+      WaitForInterrupt();
+    }
+    EndCritical(sr);
+  }
+  
+  printf("  [%d] %s %s\n\n", job->id, job->name, JOB_StateName(job->state));
+  return (job->state == JOB_DONE) ? CMD_SUCCESS : CMD_FAILURE;
+}
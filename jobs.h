@@ -0,0 +1,43 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Background jobs: a command that starts long running work (an ADC capture, a periodic task)
+// registers it here and returns right away with the job id, so the shell stays responsive.
+// The main loop calls JOB_Poll, which reports jobs as they finish; "jobs", "wait <id>" and
+// "kill <id>" manage them from the shell.
+
+#define JOB_COUNT 8                   // size of the job table, finished jobs are reused first
+
+// job states
+#define JOB_FREE    0
+#define JOB_RUNNING 1
+#define JOB_DONE    2
+#define JOB_FAILED  3
+#define JOB_KILLED  4
+
+// returns JOB_RUNNING while the work is in progress, then JOB_DONE or JOB_FAILED
+typedef int (*jobPoll)(void);
+// stops the work early
+typedef void (*jobKill)(void);
+
+typedef struct {
+  uint8_t id;                         // 1-255, 0 marks a free slot
+  uint8_t state;
+  const char* name;
+  jobPoll poll;
+  jobKill kill;
+} Job;
+
+// returns the new job's id, or 0 if every slot holds a running job
+uint8_t JOB_Start(const char* name, jobPoll poll, jobKill kill);
+Job* JOB_Find(uint8_t id);
+int JOB_Kill(uint8_t id);
+int JOB_Wait(uint8_t id);
+void JOB_Poll(void);
+void JOB_List(void);
+const char* JOB_StateName(uint8_t state);
+
+#endif
@@ -0,0 +1,74 @@
+#include "log.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+// runtime level of each module, messages above it are dropped before they are queued
+uint8_t LOG_Levels[LOG_MOD_COUNT];
+
+// must match the LOG_Module order
+const char* const LOG_ModuleNames[LOG_MOD_COUNT] = {
+  "MAIN", "UART", "FRAME", "CMD", "ADC", "OS"
+};
+
+const char* const LOG_LevelNames[LOG_LEVEL_DEBUG + 1] = {
+  "none", "error", "warn", "info", "debug"
+};
+
+/*
+========================================================================================================================
+==========                                           LOG FUNCTIONS                                            ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  LOG :: LOG_Init
+  
+   - sets every module to LOG_DEFAULT_LEVEL
+===================================================================================================
+*/
+void LOG_Init(void){
+  for (int i = 0; i < LOG_MOD_COUNT; i++){
+    LOG_Levels[i] = LOG_DEFAULT_LEVEL;
+  }
+}
+
+/*
+===================================================================================================
+  LOG :: LOG_FindModule
+  
+   - returns the module with the given name, LOG_MOD_COUNT if there is none
+===================================================================================================
+*/
+LOG_Module LOG_FindModule(const char* name){
+  int i;
+  for (i = 0; i < LOG_MOD_COUNT; i++){
+    if (strcmp(name, LOG_ModuleNames[i]) == 0) break;
+  }
+  return (LOG_Module)i;
+}
+
+/*
+===================================================================================================
+  LOG :: LOG_ParseLevel
+  
+   - accepts a level name or its number, returns -1 if neither
+===================================================================================================
+*/
+int LOG_ParseLevel(const char* text){
+  for (int i = 0; i <= LOG_LEVEL_DEBUG; i++){
+    if (strcmp(text, LOG_LevelNames[i]) == 0) return i;
+  }
+  if (text[0] >= '0' && text[0] <= '0' + LOG_LEVEL_DEBUG && text[1] == 0){
+    return text[0] - '0';
+  }
+  return -1;
+}
@@ -0,0 +1,73 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dprint.h"
+
+// Leveled logging with per-module runtime levels and compile-time elimination.
+//
+// Messages go through the deferred printf ring (see dprint.h), so the same argument rules
+// apply: at most DPRINT_MAX_ARGS integer/pointer arguments, strings must outlive the flush.
+// Each message is printed on its own line as "[LEVEL] MODULE: message".
+//
+// Anything above LOG_COMPILE_LEVEL compiles to nothing. Anything at or below it costs one
+// compare against the module's runtime level, which is changed with "set logLevel".
+//
+// e.g.,
+// LOG_WARN(ADC, "sample rate %d out of range", fs);
+
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+
+// highest level compiled in, override from the project defines (e.g. LOG_COMPILE_LEVEL=1)
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// runtime level every module starts at
+#ifndef LOG_DEFAULT_LEVEL
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_WARN
+#endif
+
+// log modules, the names used in the macros and the shell are the suffixes
+typedef enum {
+  LOG_MOD_MAIN,
+  LOG_MOD_UART,
+  LOG_MOD_FRAME,
+  LOG_MOD_CMD,
+  LOG_MOD_ADC,
+  LOG_MOD_OS,
+  LOG_MOD_COUNT
+} LOG_Module;
+
+extern uint8_t LOG_Levels[LOG_MOD_COUNT];
+extern const char* const LOG_ModuleNames[LOG_MOD_COUNT];
+extern const char* const LOG_LevelNames[LOG_LEVEL_DEBUG + 1];
+
+#define LOG_(module, level, tag, ...)                                         \
+  do {                                                                        \
+    if ((level) <= LOG_COMPILE_LEVEL && (level) <= LOG_Levels[LOG_MOD_ ## module]) { \
+      DPRINT_PostTagged(tag, DPRINT_COUNT(__VA_ARGS__), __VA_ARGS__);         \
+    }                                                                         \
+  } while (0)
+
+#define LOG_ERR(module, ...)   LOG_(module, LOG_LEVEL_ERROR, "[ERROR] " #module ": ", __VA_ARGS__)
+#define LOG_WARN(module, ...)  LOG_(module, LOG_LEVEL_WARN,  "[WARN] "  #module ": ", __VA_ARGS__)
+#define LOG_INFO(module, ...)  LOG_(module, LOG_LEVEL_INFO,  "[INFO] "  #module ": ", __VA_ARGS__)
+#define LOG_DEBUG(module, ...) LOG_(module, LOG_LEVEL_DEBUG, "[DEBUG] " #module ": ", __VA_ARGS__)
+
+// sets every module to LOG_DEFAULT_LEVEL
+void LOG_Init(void);
+
+// looks up a module by name (case sensitive), returns LOG_MOD_COUNT if not found
+LOG_Module LOG_FindModule(const char* name);
+
+// parses a level given as a name ("warn") or a number ("2"), returns -1 if invalid
+int LOG_ParseLevel(const char* text);
+
+#endif
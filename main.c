@@ -37,12 +37,23 @@
 #include "pll.h"
 #include "st7735.h"
 #include "usb_uart.h"
+#include "uart.h"
 #include "systick.h"
 #include "pwm.h"
 #include "adc.h"
 #include "timer0.h"
 #include "interpreter.h"
+#include "command.h"
+#include "os.h"
+#include "eeprom.h"
+#include "jobs.h"
+#include "params.h"
+#include "frame.h"
+#include "dprint.h"
+#include "log.h"
 #include "debug.h"
+#include "calib.h"
+#include "compare.h"
 
 #define LCD_WIDTH 128
 #define LCD_HEIGHT 160
@@ -76,7 +87,21 @@ int main(void){
   
   // init usb uart, generate interrupts when data received via usb
   USB_UART_Init();
-  USB_UART_Enable_Interrupt();
+  
+  // init deferred printf ring, flushed by the main loop, and log levels that feed it
+  DPRINT_Init();
+  LOG_Init();
+
+  // sort the command tables for binary search lookups
+  CMD_Init();
+
+  // cycle counter for command timing, EEPROM for stored scripts and parameters
+  OS_InitCycleCounter();
+  if (EEPROM_Init() != CMD_SUCCESS){
+    LOG_ERR(MAIN, "EEPROM init failed");
+  }
+  PARAM_Load();                           // defaults if nothing was saved
+  CALIB_Clear();                          // every channel reads raw codes until calibrated
     
   // init systick to generate an interrupt every 1ms (every 80000 cycles)  
   //SysTick_Init(80000);
@@ -88,6 +113,10 @@ int main(void){
   // init debug LEDs
   DEBUG_Init();
 
+  // 1ms periodic task clock, then bring up whatever the stored parameters turn on
+  OS_InitPeriodicClock(80000);
+  PARAM_ApplyAll();
+
   // global enable interrupts
   EnableInterrupts();
   
@@ -104,11 +133,33 @@ int main(void){
     */
     if (USB_BufferReady){
       USB_BufferReady = false;
-      //INTER_HandleBuffer();
-			
+
+      // one wakeup per complete line, the RX interrupt did the editing
+      char* line;
+      while (USB_UART_GetLine(&line)){
+        INTER_HandleBuffer(line);
+        USB_UART_ReleaseLine(line);
+      }
+
+      // binary frames from the host share the wakeup
+      USB_Frame* frame;
+      while (USB_UART_GetFrame(&frame)){
+        FRAME_HandleFrame(frame);
+        USB_UART_ReleaseFrame(frame);
+      }
+
 			loopcount++;
-			dd++;
-			// experimental test comment
+    }
+    
+    // format and send anything handlers queued with DPRINTF, this loop is the lowest priority
+    DPRINT_Flush();
+    
+    // report background jobs that finished
+    JOB_Poll();
+    
+    // and comparator watches that fired
+    if (OS_TakeEvents(OS_EVENT_COMPARE)){
+      COMPARE_Report();
     }
     
 		
@@ -117,8 +168,13 @@ int main(void){
 }
 
 
-// this is used for printf to output to both the screen and the usb uart
+// this is used for printf to output to both the screen and the usb uart, fprintf to a
+// UART_Stream goes to that port only
 int fputc(int ch, FILE *f){
+  if (f != stdout && f != stderr){
+    UART_PutChar(UART_StreamPort(f), ch);
+    return 1;
+  }
   if (OUTPUT_SCREEN_ENABLED) ST7735_OutChar(ch);       // output to screen
   if (OUTPUT_UART_ENABLED) USB_UART_PrintChar(ch);     // output via usb uart
   return 1;
@@ -4,13 +4,27 @@
 #include "systick.h"
 #include "defs.h"
 
+// prototypes for functions defined in startup.s
+long StartCritical (void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
+
 #define MAX_PERIODIC_TASKS 8
 
 #define DEFAULT_PRIORITY 0xFFFFFFFF
 #define DEFAULT_PERIOD   0xFFFFFFFF
 
+// core debug registers for the cycle counter (not in tm4c123gh6pm.h)
+#define DEMCR_R           (*((volatile uint32_t *)0xE000EDFC))
+#define DWT_CTRL_R        (*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R      (*((volatile uint32_t *)0xE0001004))
+#define DEMCR_TRCENA      0x01000000
+#define DWT_CTRL_CYCCNTENA 0x00000001
+
 uint32_t OS_Timer;
 
+// pending event flags (see OS_EVENT_*)
+static volatile uint32_t OS_Events;
+
 PeriodicTask OS_PeriodicTasks[MAX_PERIODIC_TASKS];
 
 // inits SysTick and OS_Timer stuff
@@ -71,18 +85,43 @@ uint32_t OS_ReadPeriodicTime(void){
   return OS_Timer;
 }
 
-// this is called every time the systick generates an interrupt
+// starts the DWT cycle counter, free running at the 80MHz core clock
+void OS_InitCycleCounter(void){
+  DEMCR_R |= DEMCR_TRCENA;         // enable the DWT unit
+  DWT_CYCCNT_R = 0;
+  DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+}
+
+// returns the cycle counter, differences are valid across one wrap (53s)
+uint32_t OS_ReadCycles(void){
+  return DWT_CYCCNT_R;
+}
+
+// posts events, safe from any interrupt
+void OS_SignalEvents(uint32_t events){
+  long sr = StartCritical();
+  OS_Events |= events;
+  EndCritical(sr);
+}
+
+// returns and clears the pending events in mask
+uint32_t OS_TakeEvents(uint32_t mask){
+  long sr = StartCritical();
+  uint32_t events = OS_Events & mask;
+  OS_Events &= ~events;
+  EndCritical(sr);
+  return events;
+}
+
+// this is called every time the systick generates an interrupt, empty slots are skipped (their
+// DEFAULT_PERIOD comes due after 49.7 days), PF2 is left to the ADC debug pulses
 void SysTick_Handler(void){
-	debug_ledToggle(PF2);
   OS_Timer++;
 
   for (int i = 0; i < MAX_PERIODIC_TASKS; i++){
-    if ((OS_Timer % OS_PeriodicTasks[i].period) == 0){
+    if (OS_PeriodicTasks[i].task != NULL && (OS_Timer % OS_PeriodicTasks[i].period) == 0){
         OS_PeriodicTasks[i].task();
     }
   }
-	debug_ledToggle(PF2);
-	
-	
 }
 
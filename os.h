@@ -21,4 +21,14 @@ uint32_t OS_AddPeriodicThread(void(*task)(void), uint32_t period, uint32_t prior
 uint32_t OS_RemovePeriodicThread(void(*task)(void));
 uint32_t OS_ReadPeriodicTime(void);
 
+void OS_InitCycleCounter(void);
+uint32_t OS_ReadCycles(void);
+
+// event flags, signalled from interrupts and taken by the main loop, which WaitForInterrupt
+// wakes for every one of them
+#define OS_EVENT_COMPARE  0x00000001   // an ADC comparator watch entered or left its region
+
+void OS_SignalEvents(uint32_t events);
+uint32_t OS_TakeEvents(uint32_t mask);          // returns and clears the pending events in mask
+
 #endif
@@ -0,0 +1,289 @@
+#include "pack.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                          BIT STREAMS                                               ==========
+========================================================================================================================
+*/
+
+typedef struct {
+  uint8_t* data;
+  uint32_t size;                // bytes available
+  uint32_t bit;                 // bits written
+} BitWriter;
+
+typedef struct {
+  const uint8_t* data;
+  uint32_t size;
+  uint32_t bit;                 // bits read
+} BitReader;
+
+/*
+===================================================================================================
+  PACK :: putBits
+  
+   - appends the low count bits of value, most significant first
+   - return false (writing nothing) if they don't fit
+===================================================================================================
+*/
+static bool putBits(BitWriter* w, uint32_t value, uint8_t count){
+  if (w->bit + count > w->size * 8){
+    return false;
+  }
+  while (count-- > 0){
+    uint8_t mask = 0x80 >> (w->bit & 7);
+    if (value & (1UL << count)){
+      w->data[w->bit >> 3] |= mask;
+    } else {
+      w->data[w->bit >> 3] &= ~mask;
+    }
+    w->bit++;
+  }
+  return true;
+}
+
+/*
+===================================================================================================
+  PACK :: getBits
+  
+   - reads count bits, most significant first
+   - return false past the end
+===================================================================================================
+*/
+static bool getBits(BitReader* r, uint8_t count, uint32_t* value){
+  uint32_t result = 0;
+  if (r->bit + count > r->size * 8){
+    return false;
+  }
+  while (count-- > 0){
+    result = (result << 1) | ((r->data[r->bit >> 3] >> (7 - (r->bit & 7))) & 1);
+    r->bit++;
+  }
+  *value = result;
+  return true;
+}
+
+/*
+========================================================================================================================
+==========                                            PACK FUNCTIONS                                          ==========
+========================================================================================================================
+*/
+
+// zigzag mapping, small differences of either sign become small values
+static uint32_t zigzag(int32_t delta){
+  return (delta < 0) ? ((uint32_t)(-delta) << 1) - 1 : (uint32_t)delta << 1;
+}
+static int32_t unzigzag(uint32_t value){
+  return (value & 1) ? -(int32_t)((value + 1) >> 1) : (int32_t)(value >> 1);
+}
+
+/*
+===================================================================================================
+  PACK :: riceParameter
+  
+   - Rice parameter for a chunk: about log2 of the mean mapped difference
+===================================================================================================
+*/
+static uint8_t riceParameter(const uint16_t* samples, uint32_t count){
+  uint32_t sum = 0;
+  for (uint32_t i = 1; i < count; i++){
+    sum += zigzag((int32_t)samples[i] - samples[i - 1]);
+  }
+  uint32_t mean = (count > 1) ? sum / (count - 1) : 0;
+  uint8_t k = 0;
+  while (k < 16 && (1UL << (k + 1)) <= mean){
+    k++;
+  }
+  return k;
+}
+
+/*
+===================================================================================================
+  PACK :: putRice
+  
+   - Rice codes one value, escaping long quotients
+   - return false if it doesn't fit
+===================================================================================================
+*/
+static bool putRice(BitWriter* w, uint32_t value, uint8_t k){
+  uint32_t quotient = value >> k;
+  uint32_t start = w->bit;
+  bool ok;
+  if (quotient >= PACK_RICE_ESCAPE){
+    ok = putBits(w, (1UL << PACK_RICE_ESCAPE) - 1, PACK_RICE_ESCAPE) && putBits(w, value, 17);
+  } else {
+    ok = putBits(w, ((1UL << quotient) - 1) << 1, quotient + 1) && putBits(w, value & ((1UL << k) - 1), k);
+  }
+  if (!ok){
+    w->bit = start;             // partial codes don't count
+  }
+  return ok;
+}
+
+/*
+===================================================================================================
+  PACK :: PACK_Encode
+  
+   - encodes as many samples as fit in size bytes, see pack.h for the format
+   - return chunk length in bytes, 0 if nothing could be encoded
+===================================================================================================
+*/
+uint32_t PACK_Encode(uint8_t mode, const uint16_t* samples, uint32_t count, uint8_t* out, uint32_t size,
+                     uint32_t* encoded){
+  uint32_t n = 0;
+  uint32_t length = PACK_HEADER_SIZE;
+  uint8_t k = 0;
+  
+  if (size <= PACK_HEADER_SIZE || count == 0){
+    return 0;
+  }
+  if (count > 0xFFFF){
+    count = 0xFFFF;
+  }
+  
+  switch (mode){
+    case PACK_RAW:
+      while (n < count && length + 2 <= size){
+        out[length++] = samples[n] & 0xFF;
+        out[length++] = samples[n] >> 8;
+        n++;
+      }
+      break;
+      
+    case PACK_12BIT:
+      while (n < count){
+        if (samples[n] > 0x0FFF || (n + 1 < count && samples[n + 1] > 0x0FFF)){
+          return 0;
+        }
+        if (n + 1 < count && length + 3 <= size){
+          // aaaaaaaa aaaabbbb bbbbbbbb
+          out[length++] = samples[n] >> 4;
+          out[length++] = ((samples[n] & 0x0F) << 4) | (samples[n + 1] >> 8);
+          out[length++] = samples[n + 1] & 0xFF;
+          n += 2;
+        } else {
+          if (length + 2 <= size){
+            out[length++] = samples[n] >> 4;
+            out[length++] = (samples[n] & 0x0F) << 4;
+            n++;
+          }
+          break;                // an odd sample ends the chunk
+        }
+      }
+      break;
+      
+    case PACK_RICE: {
+      // k from the samples this chunk is likely to hold, at most a frame's worth
+      k = riceParameter(samples, (count < 256) ? count : 256);
+      BitWriter w = { &out[PACK_HEADER_SIZE], size - PACK_HEADER_SIZE, 0 };
+      if (!putBits(&w, samples[0], 16)){
+        return 0;
+      }
+      for (n = 1; n < count; n++){
+        if (!putRice(&w, zigzag((int32_t)samples[n] - samples[n - 1]), k)){
+          break;
+        }
+      }
+      length += (w.bit + 7) / 8;
+      break;
+    }
+      
+    default:
+      return 0;
+  }
+  
+  if (n == 0){
+    return 0;
+  }
+  out[0] = mode;
+  out[1] = k;
+  out[2] = n & 0xFF;
+  out[3] = n >> 8;
+  *encoded = n;
+  return length;
+}
+
+/*
+===================================================================================================
+  PACK :: PACK_Decode
+  
+   - decodes one chunk, see pack.h for the format
+   - return the number of samples, 0 if the chunk is malformed or too long for samples
+===================================================================================================
+*/
+uint32_t PACK_Decode(const uint8_t* chunk, uint32_t length, uint16_t* samples, uint32_t max){
+  if (length < PACK_HEADER_SIZE){
+    return 0;
+  }
+  uint8_t mode = chunk[0];
+  uint8_t k = chunk[1];
+  uint32_t count = chunk[2] | (chunk[3] << 8);
+  const uint8_t* data = &chunk[PACK_HEADER_SIZE];
+  uint32_t size = length - PACK_HEADER_SIZE;
+  
+  if (count == 0 || count > max){
+    return 0;
+  }
+  
+  switch (mode){
+    case PACK_RAW:
+      if (size < count * 2){
+        return 0;
+      }
+      for (uint32_t n = 0; n < count; n++){
+        samples[n] = data[2*n] | (data[2*n + 1] << 8);
+      }
+      break;
+      
+    case PACK_12BIT:
+      if (size < (count / 2) * 3 + (count & 1) * 2){
+        return 0;
+      }
+      for (uint32_t n = 0; n < count; n += 2){
+        const uint8_t* p = &data[(n / 2) * 3];
+        samples[n] = (p[0] << 4) | (p[1] >> 4);
+        if (n + 1 < count){
+          samples[n + 1] = ((p[1] & 0x0F) << 8) | p[2];
+        }
+      }
+      break;
+      
+    case PACK_RICE: {
+      BitReader r = { data, size, 0 };
+      uint32_t value;
+      if (k > 16 || !getBits(&r, 16, &value)){
+        return 0;
+      }
+      samples[0] = value;
+      for (uint32_t n = 1; n < count; n++){
+        uint32_t quotient = 0;
+        uint32_t bit;
+        do {
+          if (!getBits(&r, 1, &bit)){
+            return 0;
+          }
+        } while (bit && ++quotient < PACK_RICE_ESCAPE);
+        if (quotient >= PACK_RICE_ESCAPE){
+          if (!getBits(&r, 17, &value)){
+            return 0;
+          }
+        } else {
+          uint32_t low;
+          if (!getBits(&r, k, &low)){
+            return 0;
+          }
+          value = (quotient << k) | low;
+        }
+        samples[n] = (uint16_t)(samples[n - 1] + unzigzag(value));
+      }
+      break;
+    }
+      
+    default:
+      return 0;
+  }
+  return count;
+}
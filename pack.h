@@ -0,0 +1,40 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Lossless sample compression for sending captures, shared with the host decoder in tools/.
+// An encoded chunk is self describing:
+//   [mode:1] [k:1] [count:2] [payload]
+// count (little endian) is the number of samples in the chunk, the encoder fits as many as the
+// output has room for, so a chunk can always go in one frame.
+//
+//   PACK_RAW   payload is count little endian uint16 samples
+//   PACK_12BIT two 12-bit samples in 3 bytes (the odd last sample takes 2), samples above
+//              4095 are refused
+//   PACK_RICE  the first sample as 16 bits, then each difference from the previous sample,
+//              zigzag mapped (0,-1,1,-2... to 0,1,2,3...) and Rice coded with parameter k: the
+//              quotient value >> k in unary (ones ended by a zero), then the low k bits. A
+//              quotient of PACK_RICE_ESCAPE or more is sent as PACK_RICE_ESCAPE ones and the
+//              value in 17 bits. Bits fill each byte from the top.
+//              k is picked per chunk from the mean difference.
+
+#define PACK_RAW   0
+#define PACK_12BIT 1
+#define PACK_RICE  2
+
+#define PACK_HEADER_SIZE 4
+#define PACK_RICE_ESCAPE 24
+
+// encodes samples from the start of samples into out (at most size bytes) and sets *encoded to
+// how many went in, returns the chunk length in bytes, 0 if not even one sample fits or the
+// samples can't be coded in mode
+uint32_t PACK_Encode(uint8_t mode, const uint16_t* samples, uint32_t count, uint8_t* out, uint32_t size,
+                     uint32_t* encoded);
+
+// decodes one chunk into samples (room for max), returns the number of samples, 0 if the chunk
+// is malformed or doesn't fit
+uint32_t PACK_Decode(const uint8_t* chunk, uint32_t length, uint16_t* samples, uint32_t max);
+
+#endif
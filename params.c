@@ -0,0 +1,201 @@
+#include "params.h"
+#include "eeprom.h"
+#include "log.h"
+#include "defs.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+#define PARAM_MAGIC 0x314D5250            // "PRM1", marks a saved parameter record in EEPROM
+
+#define PARAM_VALUES_ADDRESS (EEPROM_PARAM_ADDRESS + PARAM_HEADER_SIZE)
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+// RAM copy every reader uses, and the values last written to or read from EEPROM
+static int32_t values[PARAM_COUNT];
+static int32_t saved[PARAM_COUNT];
+
+/*
+========================================================================================================================
+==========                                          PARAM FUNCTIONS                                           ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  PARAM :: PARAM_Find
+  
+   - returns the id of the named parameter, or -1
+===================================================================================================
+*/
+int PARAM_Find(const char* name){
+  for (int i = 0; i < PARAM_COUNT; i++){
+    if (strcmp(name, PARAM_Table[i].name) == 0){
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*
+===================================================================================================
+  PARAM :: PARAM_Get / PARAM_Unsaved
+  
+   - read the RAM copy, no EEPROM access
+===================================================================================================
+*/
+int32_t PARAM_Get(uint8_t id){
+  return values[id];
+}
+bool PARAM_Unsaved(uint8_t id){
+  return values[id] != saved[id];
+}
+
+/*
+===================================================================================================
+  PARAM :: PARAM_Set
+  
+   - range checks the value, stores it in RAM and applies it
+   - return success value
+===================================================================================================
+*/
+int PARAM_Set(uint8_t id, int32_t value){
+  if (id >= PARAM_COUNT || value < PARAM_Table[id].min || value > PARAM_Table[id].max){
+    return CMD_FAILURE;
+  }
+  values[id] = value;
+  if (PARAM_Table[id].apply != NULL){
+    PARAM_Table[id].apply(value);
+  }
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  PARAM :: PARAM_ApplyAll
+  
+   - applies every parameter in id order, used once the RAM copy is loaded at boot
+===================================================================================================
+*/
+void PARAM_ApplyAll(void){
+  for (int i = 0; i < PARAM_COUNT; i++){
+    if (PARAM_Table[i].apply != NULL){
+      PARAM_Table[i].apply(values[i]);
+    }
+  }
+}
+
+/*
+===================================================================================================
+  PARAM :: PARAM_Defaults
+  
+   - sets and applies every default, nothing is written to EEPROM until PARAM_Save
+===================================================================================================
+*/
+void PARAM_Defaults(void){
+  for (int i = 0; i < PARAM_COUNT; i++){
+    values[i] = PARAM_Table[i].defaultValue;
+  }
+  PARAM_ApplyAll();
+}
+
+/*
+===================================================================================================
+  PARAM :: PARAM_Load
+  
+   - fills the RAM copy from EEPROM without applying it, parameters that are missing or out of
+     range get their defaults
+   - return success value (failure if no valid record was stored, everything is default then)
+===================================================================================================
+*/
+int PARAM_Load(void){
+  uint32_t header[PARAM_HEADER_SIZE / 4];
+  uint32_t count = 0;
+  
+  for (int i = 0; i < PARAM_COUNT; i++){
+    values[i] = PARAM_Table[i].defaultValue;
+  }
+  
+  if (EEPROM_Read(EEPROM_PARAM_ADDRESS, header, PARAM_HEADER_SIZE / 4) == CMD_SUCCESS && header[0] == PARAM_MAGIC){
+    count = header[1];
+  }
+  if (count > (EEPROM_PARAM_SIZE - PARAM_HEADER_SIZE) / 4){
+    count = 0;
+  }
+  
+  // values from firmware with more parameters than this one still count towards the check
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < count; i++){
+    uint32_t value;
+    if (EEPROM_Read(PARAM_VALUES_ADDRESS + 4*i, &value, 1) != CMD_SUCCESS){
+      count = 0;
+      break;
+    }
+    sum += value;
+    if (i < PARAM_COUNT){
+      saved[i] = (int32_t)value;
+    }
+  }
+  if (count == 0 || header[2] != ~sum){
+    for (int i = 0; i < PARAM_COUNT; i++){
+      saved[i] = values[i];
+    }
+    if (count != 0){
+      LOG_ERR(MAIN, "parameter record corrupt, using defaults");
+    }
+    return CMD_FAILURE;
+  }
+  
+  for (uint32_t i = 0; i < count && i < PARAM_COUNT; i++){
+    if (saved[i] >= PARAM_Table[i].min && saved[i] <= PARAM_Table[i].max){
+      values[i] = saved[i];
+    }
+  }
+  
+  // unsaved from here on means different from EEPROM, so parameters new to this firmware show
+  // up as unsaved until the first save
+  for (uint32_t i = count; i < PARAM_COUNT; i++){
+    saved[i] = ~values[i];
+  }
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  PARAM :: PARAM_Save
+  
+   - writes the RAM copy back, EEPROM_Write skips words that already hold their value so only
+     changed parameters (and the check word) wear the EEPROM
+   - return success value
+===================================================================================================
+*/
+int PARAM_Save(void){
+  uint32_t header[PARAM_HEADER_SIZE / 4] = { PARAM_MAGIC, PARAM_COUNT, 0 };
+  uint32_t sum = 0;
+  for (int i = 0; i < PARAM_COUNT; i++){
+    sum += (uint32_t)values[i];
+  }
+  header[2] = ~sum;
+  
+  // values first, the header last, a save cut short leaves a record that fails the check
+  if (EEPROM_Write(PARAM_VALUES_ADDRESS, (uint32_t*)values, PARAM_COUNT) != CMD_SUCCESS ||
+      EEPROM_Write(EEPROM_PARAM_ADDRESS, header, PARAM_HEADER_SIZE / 4) != CMD_SUCCESS){
+    return CMD_FAILURE;
+  }
+  for (int i = 0; i < PARAM_COUNT; i++){
+    saved[i] = values[i];
+  }
+  return CMD_SUCCESS;
+}
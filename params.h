@@ -0,0 +1,63 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "eeprom.h"
+
+// Persistent parameters: a RAM table of settings, loaded from EEPROM at boot and applied before
+// the main loop starts, so a board comes up configured without any help from the host.
+// Setting a parameter changes the RAM copy and applies it right away; PARAM_Save writes back
+// only the words that changed since the last save or load.
+//
+// EEPROM record at EEPROM_PARAM_ADDRESS:
+//   [magic] [count] [check] [value 0] ... [value count-1]
+// check is the complement of the sum of the values. A record from firmware with fewer
+// parameters keeps its values, the new ones start at their defaults.
+
+// parameter ids, index into PARAM_Table
+#define PARAM_PWM_ENABLE    0         // 1 starts PWM0A on PB6
+#define PARAM_PWM_FREQ      1         // Hz
+#define PARAM_PWM_DUTY      2         // %
+#define PARAM_LED_PERIOD    3         // ms, 0 leaves the PF3 toggler off
+#define PARAM_ADC_CHANNEL   4         // capture started at boot when PARAM_ADC_AUTOSTART is set
+#define PARAM_ADC_FREQUENCY 5
+#define PARAM_ADC_SAMPLES   6
+#define PARAM_ADC_AUTOSTART 7
+#define PARAM_ADC_HW_AVERAGE 8        // log2 of conversions averaged in hardware
+#define PARAM_ADC_DECIMATION 9        // log2 of results summed per adcCollect sample
+#define PARAM_COUNT         10
+
+#define PARAM_HEADER_SIZE 12          // magic, count and check words
+
+// makes a new value take effect, NULL for parameters that are only read by others
+typedef void (*paramApply)(int32_t value);
+
+typedef struct {
+  char* name;
+  int32_t min;
+  int32_t max;
+  int32_t defaultValue;
+  paramApply apply;
+} Param;
+
+// defined with the command tables (command.c), in id order
+extern const Param PARAM_Table[PARAM_COUNT];
+
+// returns the parameter id, or -1 if there is no parameter by that name
+int PARAM_Find(const char* name);
+int32_t PARAM_Get(uint8_t id);
+// returns true if the RAM value differs from the one in EEPROM
+bool PARAM_Unsaved(uint8_t id);
+
+// range checks, stores and applies a value, return success value
+int PARAM_Set(uint8_t id, int32_t value);
+void PARAM_Defaults(void);
+void PARAM_ApplyAll(void);
+
+// return success value, PARAM_Load falls back to the defaults if nothing valid is stored
+int PARAM_Load(void);
+int PARAM_Save(void);
+
+#endif
@@ -75,3 +75,7 @@ void PWM0A_SetDutyPercent(uint16_t dutyPercent){
 uint32_t PWM0A_GetFrequency(void){
    return (PWM_CLOCK_FREQ / _pwmPeriod);
 }
+
+uint16_t PWM0A_GetDutyPercent(void){
+   return (uint16_t)((100 * _dutyPeriod) / _pwmPeriod);
+}
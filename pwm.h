@@ -11,5 +11,6 @@ void PWM0A_SetPeriod(uint16_t period);
 void PWM0A_SetFrequency(uint32_t frequency);
 uint32_t PWM0A_GetFrequency(void);
 void PWM0A_SetDutyPercent(uint16_t dutyPercent);
+uint16_t PWM0A_GetDutyPercent(void);
 
 #endif
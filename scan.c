@@ -0,0 +1,119 @@
+#include "scan.h"
+#include "adc.h"
+#include "log.h"
+#include "defs.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+SCAN_Stream SCAN_Streams[ADC_SCAN_MAX];
+uint8_t SCAN_Count = 0;
+uint32_t SCAN_Frequency = 0;
+
+static uint16_t* scanBuffer;
+static uint32_t scanSize;
+static volatile uint32_t remaining;      // base triggers left
+
+/*
+========================================================================================================================
+==========                                            SCAN FUNCTIONS                                          ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  SCAN :: SCAN_Size
+  
+   - every channel keeps one sample per decimation base samples
+===================================================================================================
+*/
+uint32_t SCAN_Size(const SCAN_Entry* list, uint8_t count, uint32_t triggers){
+  uint32_t size = 0;
+  for (int i = 0; i < count; i++){
+    size += triggers / list[i].decimation;
+  }
+  return size;
+}
+
+/*
+===================================================================================================
+  SCAN :: SCAN_Sequence
+  
+   - sequence handler, runs in the ADC interrupt with one result per channel
+   - averages each channel over its decimation and stops after the last base trigger
+===================================================================================================
+*/
+static void SCAN_Sequence(const uint16_t* results, unsigned int count){
+  for (unsigned int i = 0; i < count; i++){
+    SCAN_Stream* stream = &SCAN_Streams[i];
+    stream->sum += results[i];
+    if (++stream->accumulated == stream->entry.decimation){
+      if (stream->count < stream->length){
+        stream->data[stream->count++] = (uint16_t)(stream->sum / stream->entry.decimation);
+      }
+      stream->sum = 0;
+      stream->accumulated = 0;
+    }
+  }
+  
+  if (--remaining == 0){
+    ADC_Stop();
+    ADCheader.flags &= ~ADC_FLAG_STOPPED;   // it ran to the end
+    ADCheader.samples = scanSize;
+    ADCBufferPointer = scanBuffer;
+    ADCsamplesMax = scanSize;
+    ADCsamples = scanSize;
+    ADCstatus = ADC_STATUS_DONE;
+    LOG_INFO(ADC, "scan done, %d samples", scanSize);
+  }
+}
+
+/*
+===================================================================================================
+  SCAN :: SCAN_Start
+  
+   - lays the channel streams out in buffer and starts converting the list
+   - return success value
+===================================================================================================
+*/
+int SCAN_Start(const SCAN_Entry* list, uint8_t count, uint32_t fs, uint32_t triggers, uint16_t* buffer){
+  uint8_t channels[ADC_SCAN_MAX];
+  uint16_t* data = buffer;
+  
+  if (count < 1 || count > ADC_SCAN_MAX || triggers == 0){
+    return CMD_FAILURE;
+  }
+  for (int i = 0; i < count; i++){
+    SCAN_Stream* stream = &SCAN_Streams[i];
+    if (list[i].decimation == 0){
+      return CMD_FAILURE;
+    }
+    stream->entry = list[i];
+    stream->data = data;
+    stream->length = triggers / list[i].decimation;
+    stream->count = 0;
+    stream->sum = 0;
+    stream->accumulated = 0;
+    data += stream->length;
+    channels[i] = list[i].channel;
+  }
+  SCAN_Count = count;
+  SCAN_Frequency = fs;
+  scanBuffer = buffer;
+  scanSize = data - buffer;
+  remaining = triggers;
+  
+  // the streams overwrite the last capture, a kill (ADC_Stop) must not publish what is left of it
+  ADCsamples = 0;
+  ADCsamplesMax = 0;
+  if (ADC_SequenceStart(channels, count, fs, SCAN_Sequence)){
+    return CMD_FAILURE;
+  }
+  return CMD_SUCCESS;
+}
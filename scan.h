@@ -0,0 +1,40 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "adc.h"
+
+// Scan lists: up to ADC_SCAN_MAX channels converted together on a common base trigger (see
+// ADC_SequenceStart), so they stay time aligned. Each channel averages its own number of base
+// samples into every output sample (its decimation), giving it its own rate, fs / decimation,
+// and its own output stream. The streams lie back to back in one buffer, which becomes the last
+// capture for FRAME_SAMPLES once the scan is done.
+
+typedef struct {
+  uint8_t channel;                    // 0-11
+  uint16_t decimation;                // base samples per output sample, at least 1
+} SCAN_Entry;
+
+// one channel's output stream
+typedef struct {
+  SCAN_Entry entry;
+  uint16_t* data;
+  uint32_t length;                    // samples it will hold, triggers / decimation
+  volatile uint32_t count;            // samples stored so far
+  uint32_t sum;                       // accumulator for the sample in progress
+  uint16_t accumulated;
+} SCAN_Stream;
+
+extern SCAN_Stream SCAN_Streams[ADC_SCAN_MAX];
+extern uint8_t SCAN_Count;
+extern uint32_t SCAN_Frequency;             // base trigger rate
+
+// returns the number of buffer samples a scan of triggers base samples needs
+uint32_t SCAN_Size(const SCAN_Entry* list, uint8_t count, uint32_t triggers);
+
+// starts the scan into buffer (SCAN_Size samples), return success value
+int SCAN_Start(const SCAN_Entry* list, uint8_t count, uint32_t fs, uint32_t triggers, uint16_t* buffer);
+
+#endif
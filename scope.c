@@ -0,0 +1,145 @@
+#include "scope.h"
+#include "adc.h"
+#include "log.h"
+#include "defs.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+volatile uint8_t SCOPE_State = SCOPE_IDLE;
+volatile uint32_t SCOPE_Seen = 0;
+volatile uint32_t SCOPE_TriggerSample = 0;
+
+static SCOPE_Trigger trigger;
+static uint16_t* ring;
+static uint32_t ringSize;                // pre + post
+static uint32_t ringIndex;               // next slot to write, the oldest sample once full
+static uint32_t remaining;               // samples left to fill in this state
+static uint16_t previous;                // last sample, for edge detection
+
+/*
+========================================================================================================================
+==========                                           SCOPE FUNCTIONS                                          ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  SCOPE :: reverse
+  
+   - reverses ring[first..last-1] in place
+===================================================================================================
+*/
+static void reverse(uint32_t first, uint32_t last){
+  while (first + 1 < last){
+    uint16_t swap = ring[first];
+    ring[first++] = ring[--last];
+    ring[last] = swap;
+  }
+}
+
+/*
+===================================================================================================
+  SCOPE :: SCOPE_Finish
+  
+   - stops streaming and rotates the ring so the oldest sample comes first (three reversals,
+     no second buffer), then publishes it as the last capture
+   - the capture header is the block's, moved back from sample last of the block to the first
+     sample of the window
+===================================================================================================
+*/
+static void SCOPE_Finish(const ADC_BlockHeader* header, uint32_t last){
+  ADC_Stop();
+  int32_t back = (int32_t)last - (int32_t)(ringSize - 1);   // samples from the block start
+  ADCheader = *header;
+  ADCheader.sequence = 0;
+  ADCheader.startCycles += back * (int32_t)header->sampleCycles;
+  ADCheader.startMs += (int32_t)(((int64_t)back * header->sampleCycles) / (ADC_BUS_HZ/1000));
+  ADCheader.samples = ringSize;
+
+  reverse(0, ringIndex);
+  reverse(ringIndex, ringSize);
+  reverse(0, ringSize);
+  
+  ADCBufferPointer = ring;
+  ADCsamplesMax = ringSize;
+  ADCsamples = ringSize;
+  ADCstatus = ADC_STATUS_DONE;
+  SCOPE_State = SCOPE_DONE;
+  LOG_INFO(ADC, "scope triggered at sample %d", SCOPE_TriggerSample);
+}
+
+/*
+===================================================================================================
+  SCOPE :: SCOPE_Block
+  
+   - streaming block handler, runs in the ADC interrupt
+   - writes every sample into the ring and steps the state machine
+===================================================================================================
+*/
+static void SCOPE_Block(uint16_t* block, uint32_t length, const ADC_BlockHeader* header){
+  for (uint32_t i = 0; i < length && SCOPE_State != SCOPE_DONE; i++){
+    uint16_t sample = block[i];
+    
+    if (SCOPE_State == SCOPE_ARMED){
+      bool rising = previous < trigger.level && sample >= trigger.level;
+      bool falling = previous >= trigger.level && sample < trigger.level;
+      if ((rising && trigger.slope != SCOPE_FALLING) || (falling && trigger.slope != SCOPE_RISING)){
+        SCOPE_State = SCOPE_TRIGGERED;
+        SCOPE_TriggerSample = SCOPE_Seen;
+        remaining = trigger.post;
+      }
+    }
+    
+    ring[ringIndex] = sample;
+    ringIndex = (ringIndex + 1 == ringSize) ? 0 : ringIndex + 1;
+    previous = sample;
+    SCOPE_Seen++;
+    
+    // the history counts from the first sample, the edge needs one sample before it
+    if (SCOPE_State != SCOPE_ARMED && --remaining == 0){
+      if (SCOPE_State == SCOPE_FILLING){
+        SCOPE_State = SCOPE_ARMED;
+      } else {
+        SCOPE_Finish(header, i);
+      }
+    }
+  }
+}
+
+/*
+===================================================================================================
+  SCOPE :: SCOPE_Start
+  
+   - streams one channel into buffer until the trigger fires and the window is complete
+   - return success value
+===================================================================================================
+*/
+int SCOPE_Start(uint8_t channel, uint32_t fs, const SCOPE_Trigger* settings, uint16_t* buffer){
+  if (settings->post == 0 || settings->slope > SCOPE_EITHER){
+    return CMD_FAILURE;
+  }
+  trigger = *settings;
+  ring = buffer;
+  ringSize = trigger.pre + trigger.post;
+  ringIndex = 0;
+  remaining = (trigger.pre > 0) ? trigger.pre : 1;
+  SCOPE_Seen = 0;
+  SCOPE_TriggerSample = 0;
+  SCOPE_State = SCOPE_FILLING;
+  
+  // the ring overwrites the last capture, a kill (ADC_Stop) must not publish what is left of it
+  ADCsamples = 0;
+  ADCsamplesMax = 0;
+  if (ADC_StreamStart(&channel, 1, fs, SCOPE_Block)){
+    SCOPE_State = SCOPE_IDLE;
+    return CMD_FAILURE;
+  }
+  return CMD_SUCCESS;
+}
@@ -0,0 +1,38 @@
+#ifndef SCOPE_H
+#define SCOPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Oscilloscope mode: streams one channel (see ADC_StreamStart) into a ring buffer without end,
+// watching every sample for a trigger. Once it fires, pre samples before the trigger and post
+// samples from it on are kept, streaming stops and the ring is unrolled so the window lies in
+// the buffer in time order, ready for FRAME_SAMPLES like any other capture.
+
+// trigger slopes
+#define SCOPE_RISING  0               // previous sample below level, this one at or above
+#define SCOPE_FALLING 1               // previous sample at or above level, this one below
+#define SCOPE_EITHER  2
+
+// states
+#define SCOPE_IDLE      0
+#define SCOPE_FILLING   1             // collecting the pre-trigger history, trigger ignored
+#define SCOPE_ARMED     2             // waiting for the trigger
+#define SCOPE_TRIGGERED 3             // collecting the post-trigger samples
+#define SCOPE_DONE      4
+
+typedef struct {
+  uint16_t level;                     // 0-4095
+  uint8_t slope;                      // SCOPE_RISING/FALLING/EITHER
+  uint32_t pre;                       // samples kept before the trigger
+  uint32_t post;                      // samples kept from the trigger on (at least 1)
+} SCOPE_Trigger;
+
+extern volatile uint8_t SCOPE_State;
+extern volatile uint32_t SCOPE_Seen;            // samples looked at since the start
+extern volatile uint32_t SCOPE_TriggerSample;   // value of SCOPE_Seen at the trigger
+
+// starts streaming into buffer (pre + post samples long), return success value
+int SCOPE_Start(uint8_t channel, uint32_t fs, const SCOPE_Trigger* trigger, uint16_t* buffer);
+
+#endif
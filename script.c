@@ -0,0 +1,232 @@
+#include "script.h"
+#include "interpreter.h"
+#include "usb_uart.h"
+#include "eeprom.h"
+#include "os.h"
+#include "defs.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+#define SCRIPT_MAGIC 0x32524353           // "SCR2", marks a saved script in EEPROM
+
+#define CYCLES_PER_US 80
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+bool SCRIPT_Capturing = false;
+
+// script text, lines separated by '\n', kept in words so it can go to EEPROM as is
+static uint32_t scriptWords[SCRIPT_SIZE / 4];
+static char* const script = (char*)scriptWords;
+static uint32_t scriptLength = 0;
+
+// set while the script runs so it can't start itself again
+static bool running = false;
+
+/*
+========================================================================================================================
+==========                                           SCRIPT FUNCTIONS                                         ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  SCRIPT :: SCRIPT_Clear
+  
+   - empties the script, zeroing the padding that goes to EEPROM with the last word
+===================================================================================================
+*/
+void SCRIPT_Clear(void){
+  memset(scriptWords, 0, sizeof(scriptWords));
+  scriptLength = 0;
+}
+
+/*
+===================================================================================================
+  SCRIPT :: SCRIPT_Begin
+  
+   - clears the script and stores the following shell lines into it until "end"
+===================================================================================================
+*/
+void SCRIPT_Begin(void){
+  SCRIPT_Clear();
+  SCRIPT_Capturing = true;
+}
+
+/*
+===================================================================================================
+  SCRIPT :: SCRIPT_Capture
+  
+   - called by the interpreter with every shell line
+   - while capturing, appends the line to the script ("end" stops capturing) and returns true,
+     otherwise returns false and the line is run as usual
+===================================================================================================
+*/
+bool SCRIPT_Capture(char* line){
+  if (!SCRIPT_Capturing){
+    return false;
+  }
+  if (strcmp(line, "end") == 0){
+    SCRIPT_Capturing = false;
+    printf("  Script stored, %u of %u bytes used.\n\n", scriptLength, SCRIPT_SIZE);
+    return true;
+  }
+
+  uint32_t length = strlen(line);
+  if (scriptLength + length + 1 > SCRIPT_SIZE){
+    SCRIPT_Capturing = false;
+    SCRIPT_Clear();
+    printf("ERROR: Script is full (%u bytes), discarded.\n\n", SCRIPT_SIZE);
+    return true;
+  }
+  memcpy(&script[scriptLength], line, length);
+  scriptLength += length;
+  script[scriptLength++] = '\n';
+  return true;
+}
+
+/*
+===================================================================================================
+  SCRIPT :: SCRIPT_Run
+  
+   - runs every stored line through the interpreter back to back, printing the cycles each
+     took (including queueing its output), and stops at the first command that fails
+   - return success value
+===================================================================================================
+*/
+int SCRIPT_Run(void){
+  char line[USB_LINE_SIZE];                 // the tokenizer works in place, keep the script intact
+  uint32_t total = 0;
+  int count = 0;
+
+  if (running){
+    printf("ERROR: Script is already running.\n\n");
+    return CMD_FAILURE;
+  }
+  running = true;
+
+  uint32_t start = 0;
+  while (start < scriptLength){
+    uint32_t end = start;
+    while (end < scriptLength && script[end] != '\n') end++;
+    uint32_t length = end - start;
+    if (length > USB_LINE_SIZE - 1) length = USB_LINE_SIZE - 1;
+    memcpy(line, &script[start], length);
+    line[length] = 0;
+    start = end + 1;
+
+    printf("> %s\n", line);
+    uint32_t cycles = OS_ReadCycles();
+    int status = INTER_Execute(line);
+    cycles = OS_ReadCycles() - cycles;
+    total += cycles;
+    count++;
+    printf("  [%u cycles, %u us]\n", cycles, cycles / CYCLES_PER_US);
+
+    if (status != CMD_SUCCESS){
+      printf("ERROR: Script stopped at command %d.\n\n", count);
+      running = false;
+      return CMD_FAILURE;
+    }
+  }
+
+  printf("  Script done, %d commands in %u cycles.\n\n", count, total);
+  running = false;
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  SCRIPT :: SCRIPT_List
+  
+   - prints the stored script with line numbers
+===================================================================================================
+*/
+void SCRIPT_List(void){
+  int number = 1;
+  bool lineStart = true;
+  for (uint32_t i = 0; i < scriptLength; i++){
+    if (lineStart) printf("  %2d  ", number++);
+    putchar(script[i]);
+    lineStart = (script[i] == '\n');
+  }
+  printf("  (%u of %u bytes)\n\n", scriptLength, SCRIPT_SIZE);
+}
+
+/*
+===================================================================================================
+  SCRIPT :: SCRIPT_Save
+  
+   - writes the script to its EEPROM region, behind a header with a magic word, the length and
+     a check word
+   - return success value
+===================================================================================================
+*/
+int SCRIPT_Save(void){
+  uint32_t words = (scriptLength + 3) / 4;
+  uint32_t header[SCRIPT_HEADER_SIZE / 4] = { SCRIPT_MAGIC, scriptLength, 0 };
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < words; i++){
+    sum += scriptWords[i];
+  }
+  header[2] = ~sum;
+  
+  // text first, the header last, a save cut short leaves a record that fails the check
+  if (EEPROM_Write(EEPROM_SCRIPT_ADDRESS + SCRIPT_HEADER_SIZE, scriptWords, words) != CMD_SUCCESS){
+    return CMD_FAILURE;
+  }
+  return EEPROM_Write(EEPROM_SCRIPT_ADDRESS, header, SCRIPT_HEADER_SIZE / 4);
+}
+
+/*
+===================================================================================================
+  SCRIPT :: SCRIPT_Load
+  
+   - reads the script back from EEPROM, fails if none was saved or the record fails its check,
+     the script in RAM is kept then
+   - return success value
+===================================================================================================
+*/
+int SCRIPT_Load(void){
+  uint32_t header[SCRIPT_HEADER_SIZE / 4];
+  if (EEPROM_Read(EEPROM_SCRIPT_ADDRESS, header, SCRIPT_HEADER_SIZE / 4) != CMD_SUCCESS){
+    return CMD_FAILURE;
+  }
+  if (header[0] != SCRIPT_MAGIC || header[1] > SCRIPT_SIZE){
+    return CMD_FAILURE;
+  }
+  
+  // check the text before it replaces the current script
+  uint32_t words = (header[1] + 3) / 4;
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < words; i++){
+    uint32_t word;
+    if (EEPROM_Read(EEPROM_SCRIPT_ADDRESS + SCRIPT_HEADER_SIZE + 4*i, &word, 1) != CMD_SUCCESS){
+      return CMD_FAILURE;
+    }
+    sum += word;
+  }
+  if (header[2] != ~sum){
+    return CMD_FAILURE;
+  }
+  
+  SCRIPT_Clear();
+  if (EEPROM_Read(EEPROM_SCRIPT_ADDRESS + SCRIPT_HEADER_SIZE, scriptWords, words) != CMD_SUCCESS){
+    return CMD_FAILURE;
+  }
+  scriptLength = header[1];
+  return CMD_SUCCESS;
+}
@@ -0,0 +1,27 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "eeprom.h"
+
+// Shell scripts: "script begin" makes the interpreter store the following lines instead of
+// running them, up to a line reading "end". "script run" then executes the stored lines back to
+// back, reporting each command's execution time in cycles, and stops at the first failure.
+// The script can be saved to and loaded from EEPROM.
+
+#define SCRIPT_HEADER_SIZE 12                                    // magic, length and check words
+#define SCRIPT_SIZE (EEPROM_SCRIPT_SIZE - SCRIPT_HEADER_SIZE)    // bytes of script text
+
+extern bool SCRIPT_Capturing;
+
+void SCRIPT_Begin(void);
+bool SCRIPT_Capture(char* line);      // returns true if the line was taken into the script
+int SCRIPT_Run(void);
+void SCRIPT_List(void);
+void SCRIPT_Clear(void);
+int SCRIPT_Save(void);
+int SCRIPT_Load(void);
+
+#endif
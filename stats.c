@@ -0,0 +1,183 @@
+#include "stats.h"
+#include "fft.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// prototypes for functions defined in startup.s
+long StartCritical (void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+uint32_t STATS_BlockLength = 1000;
+uint16_t STATS_Level = 2048;
+uint16_t STATS_Hysteresis = 0;
+volatile uint32_t STATS_Blocks = 0;
+
+static STATS_Accumulator current;       // block being filled
+static STATS_Accumulator last;          // last complete block
+static STATS_Accumulator total;
+
+// crossing detector: 1 above the band, -1 below it, 0 before the signal left it the first time
+static int8_t side;
+
+/*
+========================================================================================================================
+==========                                          STATS FUNCTIONS                                           ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  STATS :: clear
+  
+   - empties an accumulator
+===================================================================================================
+*/
+static void clear(STATS_Accumulator* acc){
+  acc->count = 0;
+  acc->min = 0xFFFF;
+  acc->max = 0;
+  acc->sum = 0;
+  acc->sumSquares = 0;
+  acc->crossings = 0;
+}
+
+/*
+===================================================================================================
+  STATS :: STATS_Configure
+  
+   - block length (at least 1) and crossing band, starts over so no block mixes settings
+===================================================================================================
+*/
+void STATS_Configure(uint32_t blockLength, uint16_t level, uint16_t hysteresis){
+  long sr = StartCritical();
+  STATS_BlockLength = (blockLength == 0) ? 1 : blockLength;
+  STATS_Level = level;
+  STATS_Hysteresis = hysteresis;
+  EndCritical(sr);
+  STATS_Reset();
+}
+
+/*
+===================================================================================================
+  STATS :: STATS_Reset
+  
+   - forgets every sample
+===================================================================================================
+*/
+void STATS_Reset(void){
+  long sr = StartCritical();
+  clear(&current);
+  clear(&last);
+  clear(&total);
+  STATS_Blocks = 0;
+  side = 0;
+  EndCritical(sr);
+}
+
+/*
+===================================================================================================
+  STATS :: STATS_Add
+  
+   - adds one sample to the current block and the total, runs in the ADC interrupt so it is
+     a handful of compares and adds, a full block moves to last
+===================================================================================================
+*/
+void STATS_Add(uint16_t sample){
+  uint32_t square = (uint32_t)sample * sample;
+  
+  if (sample < current.min) current.min = sample;
+  if (sample > current.max) current.max = sample;
+  current.sum += sample;
+  current.sumSquares += square;
+  current.count++;
+  
+  if (sample > STATS_Level + STATS_Hysteresis){
+    if (side < 0) current.crossings++;
+    side = 1;
+  } else if (sample + STATS_Hysteresis < STATS_Level){
+    if (side > 0) current.crossings++;
+    side = -1;
+  }
+  
+  if (current.count >= STATS_BlockLength){
+    if (current.min < total.min) total.min = current.min;
+    if (current.max > total.max) total.max = current.max;
+    total.sum += current.sum;
+    total.sumSquares += current.sumSquares;
+    total.count += current.count;
+    total.crossings += current.crossings;
+    last = current;
+    clear(&current);
+    STATS_Blocks++;
+  }
+}
+
+/*
+===================================================================================================
+  STATS :: STATS_AddBlock
+  
+   - adds a block of samples, like STATS_Add on each
+===================================================================================================
+*/
+void STATS_AddBlock(const uint16_t* samples, uint32_t length){
+  for (uint32_t i = 0; i < length; i++){
+    STATS_Add(samples[i]);
+  }
+}
+
+/*
+===================================================================================================
+  STATS :: STATS_Get
+  
+   - copies an accumulator out of the interrupt's way and derives the summary, the total also
+     includes the block being filled
+   - return false if there are no samples yet
+===================================================================================================
+*/
+bool STATS_Get(int which, STATS_Summary* summary){
+  STATS_Accumulator acc;
+  long sr = StartCritical();
+  if (which == STATS_LAST){
+    acc = last;
+  } else {
+    acc = total;
+    if (current.min < acc.min) acc.min = current.min;
+    if (current.max > acc.max) acc.max = current.max;
+    acc.sum += current.sum;
+    acc.sumSquares += current.sumSquares;
+    acc.count += current.count;
+    acc.crossings += current.crossings;
+  }
+  EndCritical(sr);
+  
+  if (acc.count == 0){
+    return false;
+  }
+  // sum = q*count + r, so sum*sum/count = q*q*count + 2*q*r + r*r/count, every term fits 64 bits
+  // where sum*sum would not, and the variance keeps the fraction two truncated means lose
+  uint64_t count = acc.count;
+  uint64_t q = acc.sum / count;
+  uint64_t r = acc.sum % count;
+  uint64_t squareOfSum = q * q * count + 2 * q * r + r * r / count;
+  uint64_t deviations = (acc.sumSquares > squareOfSum) ? acc.sumSquares - squareOfSum : 0;
+  uint32_t mean = (uint32_t)((acc.sum + count / 2) / count);
+  uint32_t meanSquare = (uint32_t)((acc.sumSquares + count / 2) / count);
+  uint32_t variance = (uint32_t)((deviations + count / 2) / count);
+  
+  summary->count = acc.count;
+  summary->min = acc.min;
+  summary->max = acc.max;
+  summary->peakToPeak = acc.max - acc.min;
+  summary->mean = mean;
+  summary->rms = FFT_SquareRoot(meanSquare);
+  summary->deviation = FFT_SquareRoot(variance);
+  summary->crossings = acc.crossings;
+  return true;
+}
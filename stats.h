@@ -0,0 +1,57 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Running statistics of one channel, fed sample by sample from the ADC interrupts (adcCollect
+// captures and one channel streams) so a capture can be summarized without sending it. Samples
+// are split into blocks of a set length: the block being filled, the last complete one, and
+// the total since the capture started are kept.
+//
+// Zero crossings count passes through a level with hysteresis: the signal has to get more than
+// hysteresis above the level, then more than hysteresis below it (or the other way) to count.
+
+typedef struct {
+  uint32_t count;
+  uint16_t min;
+  uint16_t max;
+  uint64_t sum;
+  uint64_t sumSquares;
+  uint32_t crossings;
+} STATS_Accumulator;
+
+// derived numbers of an accumulator, in codes
+typedef struct {
+  uint32_t count;
+  uint16_t min;
+  uint16_t max;
+  uint16_t peakToPeak;
+  uint16_t mean;
+  uint16_t rms;                       // sqrt(mean of squares), DC included
+  uint16_t deviation;                 // AC rms, standard deviation around the mean
+  uint32_t crossings;
+} STATS_Summary;
+
+#define STATS_LAST  0                 // last complete block
+#define STATS_TOTAL 1                 // everything since STATS_Reset
+
+extern uint32_t STATS_BlockLength;
+extern uint16_t STATS_Level;
+extern uint16_t STATS_Hysteresis;
+extern volatile uint32_t STATS_Blocks;  // complete blocks since STATS_Reset
+
+// sets block length and crossing band, and starts over
+void STATS_Configure(uint32_t blockLength, uint16_t level, uint16_t hysteresis);
+
+// starts over, called when a capture starts
+void STATS_Reset(void);
+
+// adds samples, from the ADC interrupts
+void STATS_Add(uint16_t sample);
+void STATS_AddBlock(const uint16_t* samples, uint32_t length);
+
+// summary of STATS_LAST or STATS_TOTAL, returns false if it has no samples yet
+bool STATS_Get(int which, STATS_Summary* summary);
+
+#endif
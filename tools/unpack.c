@@ -0,0 +1,119 @@
+// Host side decoder for FRAME_PACKED chunks (see pack.h), built from the same pack.c the board
+// uses:
+//
+//   cc -I.. -o unpack unpack.c ../pack.c -lm
+//
+//   unpack chunks.bin      decodes a file of chunks, each preceded by its length as a little
+//                          endian uint16 (the FRAME_PACKED response payloads after the status
+//                          byte), and prints one sample per line
+//   unpack --selftest      encodes and decodes test signals in every mode and checks they come
+//                          back unchanged, printing bits per sample
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pack.h"
+
+#define CHUNK_SIZE  250         // room a frame leaves for a chunk
+#define MAX_SAMPLES 4096
+
+/*
+===================================================================================================
+  UNPACK :: roundTrip
+  
+   - encodes samples chunk by chunk in mode, decodes them back and compares
+   - return the encoded size in bytes, 0 on a mismatch
+===================================================================================================
+*/
+static unsigned long roundTrip(const uint16_t* samples, uint32_t count, uint8_t mode){
+  static uint16_t decoded[MAX_SAMPLES];
+  uint8_t chunk[CHUNK_SIZE];
+  unsigned long bytes = 0;
+  uint32_t done = 0;
+  
+  while (done < count){
+    uint32_t encoded;
+    uint32_t length = PACK_Encode(mode, &samples[done], count - done, chunk, sizeof(chunk), &encoded);
+    if (length == 0 || PACK_Decode(chunk, length, &decoded[done], count - done) != encoded){
+      return 0;
+    }
+    done += encoded;
+    bytes += length;
+  }
+  return memcmp(samples, decoded, count * sizeof(uint16_t)) == 0 ? bytes : 0;
+}
+
+/*
+===================================================================================================
+  UNPACK :: selfTest
+  
+   - round trips a slow sine with noise, a square wave, full scale noise and a 16-bit ramp
+   - return 0 if every supported case decodes unchanged
+===================================================================================================
+*/
+static int selfTest(void){
+  static const char* const names[] = { "raw", "12bit", "rice" };
+  static uint16_t samples[MAX_SAMPLES];
+  int failures = 0;
+  
+  for (int signal = 0; signal < 4; signal++){
+    const char* label = "";
+    srand(signal + 1);
+    for (int n = 0; n < MAX_SAMPLES; n++){
+      switch (signal){
+        case 0: label = "sine+noise"; samples[n] = 2048 + (int)(1500 * sin(n * 0.01)) + rand() % 9 - 4; break;
+        case 1: label = "square"; samples[n] = ((n / 100) & 1) ? 3900 : 200; break;
+        case 2: label = "noise"; samples[n] = rand() & 0x0FFF; break;
+        case 3: label = "16-bit ramp"; samples[n] = (uint16_t)(n * 16); break;
+      }
+    }
+    for (uint8_t mode = PACK_RAW; mode <= PACK_RICE; mode++){
+      unsigned long bytes = roundTrip(samples, MAX_SAMPLES, mode);
+      bool refused = (mode == PACK_12BIT && signal == 3);
+      if (bytes == 0 && !refused){
+        failures++;
+      }
+      printf("  %-12s %-6s %s", label, names[mode], (bytes == 0) ? (refused ? "refused\n" : "FAILED\n") : "");
+      if (bytes != 0){
+        printf("%5.2f bits/sample\n", bytes * 8.0 / MAX_SAMPLES);
+      }
+    }
+  }
+  printf("%s\n", failures ? "selftest FAILED" : "selftest passed");
+  return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv){
+  if (argc != 2){
+    fprintf(stderr, "usage: %s chunks.bin | --selftest\n", argv[0]);
+    return 2;
+  }
+  if (strcmp(argv[1], "--selftest") == 0){
+    return selfTest();
+  }
+  
+  FILE* file = fopen(argv[1], "rb");
+  if (file == NULL){
+    perror(argv[1]);
+    return 1;
+  }
+  uint8_t header[2];
+  uint8_t chunk[65536];
+  static uint16_t samples[65536];
+  while (fread(header, 1, 2, file) == 2){
+    uint32_t length = header[0] | (header[1] << 8);
+    uint32_t count;
+    if (fread(chunk, 1, length, file) != length || (count = PACK_Decode(chunk, length, samples, 65536)) == 0){
+      fprintf(stderr, "bad chunk\n");
+      fclose(file);
+      return 1;
+    }
+    for (uint32_t i = 0; i < count; i++){
+      printf("%u\n", samples[i]);
+    }
+  }
+  fclose(file);
+  return 0;
+}
@@ -0,0 +1,497 @@
+#include "tm4c123gh6pm.h"
+#include "uart.h"
+#include "defs.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                             CONSTANTS                                              ==========
+========================================================================================================================
+*/
+
+// register offsets within a UART block
+#define UART_O_DR   0x000
+#define UART_O_ECR  0x004
+#define UART_O_FR   0x018
+#define UART_O_IBRD 0x024
+#define UART_O_FBRD 0x028
+#define UART_O_LCRH 0x02C
+#define UART_O_CTL  0x030
+#define UART_O_IFLS 0x034
+#define UART_O_IM   0x038
+#define UART_O_RIS  0x03C
+#define UART_O_ICR  0x044
+#define UART_O_CC   0xFC8
+
+// register offsets within a GPIO block
+#define GPIO_O_AFSEL 0x420
+#define GPIO_O_DEN   0x51C
+#define GPIO_O_LOCK  0x520
+#define GPIO_O_CR    0x524
+#define GPIO_O_AMSEL 0x528
+#define GPIO_O_PCTL  0x52C
+
+#define UART_REG(port, offset) (*((volatile uint32_t *)((port)->config->base + (offset))))
+#define GPIO_REG(base, offset) (*((volatile uint32_t *)((base) + (offset))))
+
+#define RX_ERROR_BITS (UART_DR_OE | UART_DR_BE | UART_DR_PE | UART_DR_FE)
+
+// GPIO port numbers (RCGCGPIO bits) and blocks
+#define PORTA 0
+#define PORTB 1
+#define PORTC 2
+#define PORTD 3
+#define PORTE 4
+
+#define GPIOA 0x40004000
+#define GPIOB 0x40005000
+#define GPIOC 0x40006000
+#define GPIOD 0x40007000
+#define GPIOE 0x40024000
+
+static const UART_Config configs[UART_NUM_PORTS] = {
+  { 0x4000C000, GPIOA, PORTA, 0x03, 0,     0,     0,    5 },   // UART0 PA0/PA1
+  { 0x4000D000, GPIOB, PORTB, 0x03, GPIOC, PORTC, 0x30, 6 },   // UART1 PB0/PB1, RTS/CTS PC4/PC5
+  { 0x4000E000, GPIOD, PORTD, 0xC0, 0,     0,     0,    33 },  // UART2 PD6/PD7
+  { 0x4000F000, GPIOC, PORTC, 0xC0, 0,     0,     0,    56 },  // UART3 PC6/PC7
+  { 0x40010000, GPIOC, PORTC, 0x30, 0,     0,     0,    57 },  // UART4 PC4/PC5
+  { 0x40011000, GPIOE, PORTE, 0x30, 0,     0,     0,    58 },  // UART5 PE4/PE5
+  { 0x40012000, GPIOD, PORTD, 0x30, 0,     0,     0,    59 },  // UART6 PD4/PD5
+  { 0x40013000, GPIOE, PORTE, 0x03, 0,     0,     0,    60 },  // UART7 PE0/PE1
+};
+
+// prototypes for functions defined in startup.s
+long StartCritical (void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+UART_Port UART_Ports[UART_NUM_PORTS] = {
+  { &configs[0], 0 }, { &configs[1], 1 }, { &configs[2], 2 }, { &configs[3], 3 },
+  { &configs[4], 4 }, { &configs[5], 5 }, { &configs[6], 6 }, { &configs[7], 7 },
+};
+
+// printf retargeting (see fputc in main.c), the library leaves FILE for us to define
+struct __FILE { int handle; };
+static FILE streams[UART_NUM_PORTS] = { {0}, {1}, {2}, {3}, {4}, {5}, {6}, {7} };
+
+/*
+========================================================================================================================
+==========                                           UART FUNCTIONS                                           ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  UART :: UART_ConfigurePins
+
+   - clocks a GPIO port and hands the given pins to the UART with the given PCTL function
+===================================================================================================
+*/
+static void UART_ConfigurePins(uint32_t base, uint8_t port, uint8_t pins, uint32_t function){
+  SYSCTL_RCGCGPIO_R |= (1 << port);                 // activate port clock gating
+  while ((SYSCTL_PRGPIO_R & (1 << port)) == 0) {};  // wait for port to activate
+
+  uint32_t pctlMask = 0;
+  for (int i = 0; i < 8; i++){
+    if (pins & (1 << i)) pctlMask |= (0xF << (4*i));
+  }
+
+  GPIO_REG(base, GPIO_O_LOCK)   = GPIO_LOCK_KEY;    // PD7 (UART2 TX) is locked out of reset
+  GPIO_REG(base, GPIO_O_CR)    |= pins;
+  GPIO_REG(base, GPIO_O_AFSEL) |= pins;
+  GPIO_REG(base, GPIO_O_DEN)   |= pins;
+  GPIO_REG(base, GPIO_O_AMSEL) &= ~pins;
+  GPIO_REG(base, GPIO_O_PCTL)   = (GPIO_REG(base, GPIO_O_PCTL) & ~pctlMask) | (pctlMask & (0x11111111 * function));
+}
+
+/*
+===================================================================================================
+  UART :: UART_PinsTaken
+
+   - true if another open port uses any of the pins, as RX/TX or as RTS/CTS with hardware flow
+     control on (UART1's RTS/CTS and UART4's RX/TX are both PC4/PC5)
+===================================================================================================
+*/
+static bool UART_PinsTaken(const UART_Port* port, uint32_t base, uint8_t pins){
+  for (int i = 0; i < UART_NUM_PORTS; i++){
+    const UART_Port* other = &UART_Ports[i];
+    if (other == port || !other->open){
+      continue;
+    }
+    if (other->config->gpioBase == base && (other->config->pins & pins)){
+      return true;
+    }
+    if (other->flow == UART_FLOW_RTSCTS && other->config->flowGpioBase == base && (other->config->flowPins & pins)){
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+===================================================================================================
+  UART :: UART_Open
+
+   - initializes a UART on its default pins at the given baud rate, 8N1, with interrupts on
+   - fails if another open port already has one of its pins
+   - return success value
+===================================================================================================
+*/
+int UART_Open(UART_Port* port, uint32_t baud, uint8_t flow){
+  const UART_Config* config = port->config;
+  if (baud < 300 || baud > 5000000 || flow > UART_FLOW_RTSCTS){
+    return CMD_FAILURE;
+  }
+  if (flow == UART_FLOW_RTSCTS && config->flowPins == 0){
+    return CMD_FAILURE;
+  }
+  if (UART_PinsTaken(port, config->gpioBase, config->pins) ||
+      (flow == UART_FLOW_RTSCTS && UART_PinsTaken(port, config->flowGpioBase, config->flowPins))){
+    return CMD_FAILURE;
+  }
+
+  long sr = StartCritical();
+  port->txPut = port->txGet = 0;
+  port->rxPut = port->rxGet = 0;
+  port->txControl = 0;
+  port->rxPaused = false;
+  port->txPaused = false;
+  port->flow = flow;
+
+  // enable the UART
+  SYSCTL_RCGCUART_R |= (1 << port->number);         // activate UART clock gating
+  while ((SYSCTL_PRUART_R & (1 << port->number)) == 0) {}; // wait for UART to activate
+
+  UART_ConfigurePins(config->gpioBase, config->gpioPort, config->pins, 1);
+  if (flow == UART_FLOW_RTSCTS){
+    UART_ConfigurePins(config->flowGpioBase, config->flowGpioPort, config->flowPins, 8);
+  }
+
+  // BRD = 80e6/(16*baud), in 1/64ths: 80e6*4/baud, rounded
+  uint32_t divider = (80000000*4 + baud/2) / baud;
+  UART_REG(port, UART_O_CTL) &= ~UART_CTL_UARTEN;   // clear enable bit during config
+  UART_REG(port, UART_O_IBRD) = divider >> 6;       // set integer portion of BRD
+  UART_REG(port, UART_O_FBRD) = divider & 0x3F;     // set fraction portion of BRD
+  UART_REG(port, UART_O_LCRH) = (UART_LCRH_WLEN_8|UART_LCRH_FEN); // 8 bit word length, 1 stop, no parity, FIFOs enabled
+  UART_REG(port, UART_O_CC)   = 0x00;               // use system clock
+  UART_REG(port, UART_O_IFLS) = (UART_IFLS_RX4_8|UART_IFLS_TX1_8); // RX >= 1/2 full (time-out covers the rest), TX <= 1/8
+  UART_REG(port, UART_O_IM)   = (UART_IM_RXIM | UART_IM_RTIM | UART_IM_TXIM);
+  if (flow == UART_FLOW_RTSCTS){
+    UART_REG(port, UART_O_CTL) |= (UART_CTL_RTSEN | UART_CTL_CTSEN); // hardware drives RTS from RX FIFO level, obeys CTS
+  } else {
+    UART_REG(port, UART_O_CTL) &= ~(UART_CTL_RTSEN | UART_CTL_CTSEN);
+  }
+  UART_REG(port, UART_O_CTL) |= UART_CTL_UARTEN;    // set enable bit
+
+  // priority registers are byte addressable, enable registers are write one to set
+  ((volatile uint8_t *)&NVIC_PRI0_R)[config->irq] = (UART_PRIORITY << 5);
+  (&NVIC_EN0_R)[config->irq >> 5] = (1 << (config->irq & 31));
+
+  port->open = true;
+  EndCritical(sr);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  UART :: UART_SendControl
+
+   - sends an XON/XOFF ahead of anything queued, straight into the hardware FIFO if it has room
+===================================================================================================
+*/
+static void UART_SendControl(UART_Port* port, char control){
+  if ((UART_REG(port, UART_O_FR) & UART_FR_TXFF) == 0){
+    UART_REG(port, UART_O_DR) = control;
+  } else {
+    port->txControl = control;                      // UART_ServiceTX sends it first
+  }
+}
+
+/*
+===================================================================================================
+  UART :: UART_ServiceTX
+
+   - copies characters from the software TX ring into the hardware TX FIFO until either is
+     full/empty, the UART itself holds off while CTS is deasserted
+===================================================================================================
+*/
+static void UART_ServiceTX(UART_Port* port){
+  if (port->txControl && (UART_REG(port, UART_O_FR) & UART_FR_TXFF) == 0){  // pending XON/XOFF goes first, even when paused
+    UART_REG(port, UART_O_DR) = port->txControl;
+    port->txControl = 0;
+  }
+  while (((UART_REG(port, UART_O_FR) & UART_FR_TXFF) == 0) && (port->txPut != port->txGet) && !port->txPaused){
+    UART_REG(port, UART_O_DR) = port->txData[port->txGet & (UART_TX_SIZE - 1)];
+    port->txGet++;
+  }
+}
+
+/*
+===================================================================================================
+  UART :: UART_ServiceRX
+
+   - drains the hardware RX FIFO, counting errors and discarding characters with break, parity
+     or framing errors, into the RX handler or the software RX ring
+   - in ring mode XON/XOFF (when enabled) pause/resume our transmitter, and the sender is paused
+     once the ring is 3/4 full
+   - stops while RTS/CTS throttled, so the hardware FIFO fills and the UART deasserts RTS
+===================================================================================================
+*/
+static void UART_ServiceRX(UART_Port* port){
+  while ((UART_REG(port, UART_O_FR) & UART_FR_RXFE) == 0){
+    if (port->rxPaused && port->flow == UART_FLOW_RTSCTS){
+      return;                                       // UART_ThrottleRX turns RX back on
+    }
+    uint32_t data = UART_REG(port, UART_O_DR);      // take a character from the hardware fifo
+    if (data & RX_ERROR_BITS){
+      if (data & UART_DR_OE) port->errors.overrun++;
+      if (data & UART_DR_BE) port->errors.breaks++;
+      if (data & UART_DR_PE) port->errors.parity++;
+      if (data & UART_DR_FE) port->errors.framing++;
+      UART_REG(port, UART_O_ECR) = 0;               // clear the receive status register
+      if (data & (UART_DR_BE | UART_DR_PE | UART_DR_FE)){
+        continue;                                   // character itself is garbage (overrun's isn't)
+      }
+    }
+    char letter = (char)(data & UART_DR_DATA_M);
+
+    if (port->rxHandler != NULL){
+      port->rxHandler(port, letter);
+      continue;
+    }
+    if (port->flow == UART_FLOW_XONXOFF && (letter == UART_XON || letter == UART_XOFF)){
+      port->txPaused = (letter == UART_XOFF);
+      continue;
+    }
+    if (port->rxPut - port->rxGet >= UART_RX_SIZE){
+      port->errors.dropped++;
+      continue;
+    }
+    port->rxData[port->rxPut & (UART_RX_SIZE - 1)] = letter;
+    port->rxPut++;
+    if (port->rxPut - port->rxGet >= UART_RX_SIZE - UART_RX_SIZE/4){
+      UART_ThrottleRX(port, true);
+    }
+  }
+  UART_ServiceTX(port);                             // start sending any echo or freed XON
+}
+
+/*
+===================================================================================================
+  UART :: UART_HandleInterrupt
+
+   - handles incoming and outgoing interrupts of one port
+===================================================================================================
+*/
+static void UART_HandleInterrupt(UART_Port* port){
+  // RX FIFO >= 1/2 full or receiver time-out, also drains characters flagged with errors
+  if (UART_REG(port, UART_O_RIS) & (UART_RIS_RXRIS | UART_RIS_RTRIS)){
+    UART_REG(port, UART_O_ICR) = (UART_ICR_RXIC | UART_ICR_RTIC);
+    UART_ServiceRX(port);
+  }
+
+  // hardware TX FIFO <= 2 items
+  if (UART_REG(port, UART_O_RIS) & UART_RIS_TXRIS){
+    UART_REG(port, UART_O_ICR) = UART_ICR_TXIC;
+    UART_ServiceTX(port);
+  }
+}
+
+void UART0_Handler(void){ UART_HandleInterrupt(&UART_Ports[0]); }
+void UART1_Handler(void){ UART_HandleInterrupt(&UART_Ports[1]); }
+void UART2_Handler(void){ UART_HandleInterrupt(&UART_Ports[2]); }
+void UART3_Handler(void){ UART_HandleInterrupt(&UART_Ports[3]); }
+void UART4_Handler(void){ UART_HandleInterrupt(&UART_Ports[4]); }
+void UART5_Handler(void){ UART_HandleInterrupt(&UART_Ports[5]); }
+void UART6_Handler(void){ UART_HandleInterrupt(&UART_Ports[6]); }
+void UART7_Handler(void){ UART_HandleInterrupt(&UART_Ports[7]); }
+
+/*
+===================================================================================================
+  UART :: UART_PutChar
+
+   - queues a character for output
+   - spins (draining the hardware FIFO by polling) only when the software TX ring is full,
+     so it is also safe to call with interrupts disabled
+   - while spinning the RX side is polled too, otherwise an XON from the receiver could never
+     arrive to unpause us
+===================================================================================================
+*/
+void UART_PutChar(UART_Port* port, char data){
+  if (!port->open){
+    return;
+  }
+  long sr = StartCritical();              // RX interrupt echo also puts into the ring
+  while (port->txPut - port->txGet >= UART_TX_SIZE){
+    UART_ServiceRX(port);
+    UART_ServiceTX(port);
+  }
+  port->txData[port->txPut & (UART_TX_SIZE - 1)] = data;
+  port->txPut++;
+  UART_ServiceTX(port);                   // prime the hardware FIFO so the TX interrupt keeps going
+  EndCritical(sr);
+}
+
+/*
+===================================================================================================
+  UART :: UART_Write
+
+   - queues a block of bytes for output
+===================================================================================================
+*/
+void UART_Write(UART_Port* port, const uint8_t* data, uint32_t length){
+  for (uint32_t i = 0; i < length; i++){
+    UART_PutChar(port, data[i]);
+  }
+}
+
+/*
+===================================================================================================
+  UART :: UART_TryPutChar
+
+   - queues a character from interrupt context, never blocks
+   - returns false if the TX ring is full and the character was dropped
+===================================================================================================
+*/
+bool UART_TryPutChar(UART_Port* port, char data){
+  if (port->txPut - port->txGet >= UART_TX_SIZE){
+    return false;
+  }
+  port->txData[port->txPut & (UART_TX_SIZE - 1)] = data;
+  port->txPut++;
+  return true;
+}
+
+/*
+===================================================================================================
+  UART :: UART_GetChar
+
+   - takes a received character if there is one, resuming the sender once the ring drains
+===================================================================================================
+*/
+bool UART_GetChar(UART_Port* port, char* data){
+  if (port->rxPut == port->rxGet){
+    return false;
+  }
+  *data = port->rxData[port->rxGet & (UART_RX_SIZE - 1)];
+  port->rxGet++;
+  if (port->rxPaused && port->rxPut - port->rxGet <= UART_RX_SIZE/4){
+    long sr = StartCritical();
+    UART_ThrottleRX(port, false);
+    EndCritical(sr);
+  }
+  return true;
+}
+
+/*
+===================================================================================================
+  UART :: UART_RxSize
+
+   - number of characters waiting in the software RX ring
+===================================================================================================
+*/
+uint32_t UART_RxSize(UART_Port* port){
+  return port->rxPut - port->rxGet;
+}
+
+/*
+===================================================================================================
+  UART :: UART_ThrottleRX
+
+   - asks the sender to pause or resume: XOFF/XON in band, or masking the RX interrupts so the
+     hardware FIFO fills and the UART deasserts RTS, nothing without flow control
+   - call with interrupts disabled from outside the port's interrupt
+===================================================================================================
+*/
+void UART_ThrottleRX(UART_Port* port, bool pause){
+  if (pause == port->rxPaused || port->flow == UART_FLOW_NONE){
+    return;
+  }
+  port->rxPaused = pause;
+  if (pause){
+    port->errors.xoffSent++;
+  }
+
+  if (port->flow == UART_FLOW_XONXOFF){
+    UART_SendControl(port, pause ? UART_XOFF : UART_XON);
+  } else if (pause){
+    UART_REG(port, UART_O_IM) &= ~(UART_IM_RXIM | UART_IM_RTIM);
+  } else {
+    UART_REG(port, UART_O_IM) |= (UART_IM_RXIM | UART_IM_RTIM);
+    UART_ServiceRX(port);                           // pick up what collected meanwhile
+  }
+}
+
+/*
+===================================================================================================
+  UART :: UART_HoldTX
+
+   - pauses/resumes our transmitter, for RX handlers that decode XON/XOFF themselves
+===================================================================================================
+*/
+void UART_HoldTX(UART_Port* port, bool hold){
+  port->txPaused = hold;
+  if (!hold){
+    UART_ServiceTX(port);
+  }
+}
+
+/*
+===================================================================================================
+  UART :: UART_SetFlowControl
+
+   - changes flow control on an open port, RTS/CTS can only be chosen when opening
+   - return success value
+===================================================================================================
+*/
+int UART_SetFlowControl(UART_Port* port, uint8_t flow){
+  if (!port->open || flow > UART_FLOW_XONXOFF || port->flow == UART_FLOW_RTSCTS){
+    return CMD_FAILURE;
+  }
+  long sr = StartCritical();
+  if (port->flow == UART_FLOW_XONXOFF && port->rxPaused){
+    UART_SendControl(port, UART_XON);     // don't leave the sender paused forever
+  }
+  port->flow = flow;
+  port->rxPaused = false;
+  port->txPaused = false;
+  UART_ServiceTX(port);
+  EndCritical(sr);
+  return CMD_SUCCESS;
+}
+
+/*
+===================================================================================================
+  UART :: UART_SetRxHandler
+
+   - installs (or with NULL removes) a handler that takes every received character
+===================================================================================================
+*/
+void UART_SetRxHandler(UART_Port* port, UART_RxHandler handler){
+  long sr = StartCritical();
+  port->rxHandler = handler;
+  EndCritical(sr);
+}
+
+/*
+===================================================================================================
+  UART :: printf streams
+
+   - each port has a FILE whose handle is the port number
+===================================================================================================
+*/
+FILE* UART_Stream(UART_Port* port){
+  return &streams[port->number];
+}
+
+UART_Port* UART_StreamPort(FILE* stream){
+  return &UART_Ports[stream->handle & (UART_NUM_PORTS - 1)];
+}
@@ -0,0 +1,112 @@
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Generic UART port: one UART_Port per hardware UART (UART0-UART7), each with its own register
+// block, software TX/RX rings, flow control state, error counters and printf stream.
+//
+// Default pins (PCTL 1 on every one):
+//   UART0 PA0/PA1   UART1 PB0/PB1   UART2 PD6/PD7   UART3 PC6/PC7
+//   UART4 PC4/PC5   UART5 PE4/PE5   UART6 PD4/PD5   UART7 PE0/PE1
+// UART1 also has RTS/CTS on PC4/PC5, so UART4 and UART1 with RTS/CTS can't be used together.
+//
+// Received characters go into the port's RX ring unless an RX handler is installed, in which
+// case the handler sees every character from the interrupt (the shell's line discipline in
+// usb_uart.c works this way). Handlers that buffer on their own use UART_ThrottleRX and
+// UART_HoldTX for flow control.
+
+#define UART_NUM_PORTS 8
+#define UART_TX_SIZE  128           // size of each software TX ring (must be power of 2)
+#define UART_RX_SIZE  64            // size of each software RX ring (must be power of 2)
+#define UART_PRIORITY 2             // NVIC priority of every UART interrupt
+
+// flow control modes
+#define UART_FLOW_NONE     0
+#define UART_FLOW_XONXOFF  1          // software, in band (text only, see USB_UART_HandleRXChar)
+#define UART_FLOW_RTSCTS   2          // hardware, needs a UART with RTS/CTS pins (UART1 only)
+
+#define UART_XON  0x11
+#define UART_XOFF 0x13
+
+// receive error and flow control counters
+typedef struct {
+  uint32_t overrun;                   // hardware RX FIFO overflowed, characters were lost
+  uint32_t framing;                   // bad stop bit, character discarded
+  uint32_t parity;                    // parity mismatch, character discarded
+  uint32_t breaks;                    // line held low longer than a character, discarded
+  uint32_t dropped;                   // received fine but no software buffer room
+  uint32_t xoffSent;                  // number of times we asked the sender to pause
+} UART_ErrorCounts;
+
+// fixed wiring of one UART
+typedef struct {
+  uint32_t base;                      // UART register block
+  uint32_t gpioBase;                  // GPIO port with the RX/TX pins
+  uint8_t gpioPort;                   // RCGCGPIO bit number of that port
+  uint8_t pins;                       // RX/TX pin mask
+  uint32_t flowGpioBase;              // GPIO port with the RTS/CTS pins
+  uint8_t flowGpioPort;
+  uint8_t flowPins;                   // RTS/CTS pin mask, 0 if the UART has none
+  uint8_t irq;                        // interrupt number (vector number - 16)
+} UART_Config;
+
+typedef struct UART_Port UART_Port;
+
+// called from the interrupt with every good character when installed
+typedef void (*UART_RxHandler)(UART_Port* port, char data);
+
+struct UART_Port {
+  const UART_Config* config;
+  uint8_t number;                     // 0-7, also the handle of its printf stream
+  bool open;
+  uint8_t flow;                       // UART_FLOW_*
+  bool rxPaused;                      // we asked the sender to pause (XOFF sent / RX masked)
+  bool txPaused;                      // the receiver sent XOFF
+  char txControl;                     // XON/XOFF waiting to jump the TX queue
+  UART_RxHandler rxHandler;           // NULL: characters go into the RX ring
+  volatile uint32_t txPut, txGet;     // free running ring indices
+  volatile uint32_t rxPut, rxGet;
+  char txData[UART_TX_SIZE];
+  char rxData[UART_RX_SIZE];
+  UART_ErrorCounts errors;
+};
+
+extern UART_Port UART_Ports[UART_NUM_PORTS];
+
+// opens a port, baud is any rate up to 5Mbps (80MHz/16), returns CMD_FAILURE if the rate or
+// flow control mode isn't possible on this port, or another open port has one of its pins
+int UART_Open(UART_Port* port, uint32_t baud, uint8_t flow);
+int UART_SetFlowControl(UART_Port* port, uint8_t flow);
+void UART_SetRxHandler(UART_Port* port, UART_RxHandler handler);
+
+// queues a character, spinning only while the TX ring is full (safe with interrupts disabled)
+void UART_PutChar(UART_Port* port, char data);
+void UART_Write(UART_Port* port, const uint8_t* data, uint32_t length);
+// queues a character from interrupt context, returns false (dropping it) if the ring is full
+bool UART_TryPutChar(UART_Port* port, char data);
+
+// non-blocking, returns false if nothing was received
+bool UART_GetChar(UART_Port* port, char* data);
+uint32_t UART_RxSize(UART_Port* port);
+
+// flow control for RX handlers: pause/resume the sender, pause/resume our transmitter
+void UART_ThrottleRX(UART_Port* port, bool pause);
+void UART_HoldTX(UART_Port* port, bool hold);
+
+// printf routing: fprintf(UART_Stream(port), ...) writes to that port, stdout goes to the shell
+FILE* UART_Stream(UART_Port* port);
+UART_Port* UART_StreamPort(FILE* stream);
+
+void UART0_Handler(void);
+void UART1_Handler(void);
+void UART2_Handler(void);
+void UART3_Handler(void);
+void UART4_Handler(void);
+void UART5_Handler(void);
+void UART6_Handler(void);
+void UART7_Handler(void);
+
+#endif
@@ -0,0 +1,101 @@
+#include "tm4c123gh6pm.h"
+#include "udma.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+========================================================================================================================
+==========                                          GLOBAL VARIABLES                                          ==========
+========================================================================================================================
+*/
+
+// primary structures for channels 0-31, then the alternate ones, the controller needs the
+// table on a 1024 byte boundary
+static UDMA_Control UDMA_Table[2*UDMA_CHANNELS] __attribute__((aligned(1024)));
+
+/*
+========================================================================================================================
+==========                                            UDMA FUNCTIONS                                          ==========
+========================================================================================================================
+*/
+
+/*
+===================================================================================================
+  UDMA :: UDMA_Init
+  
+   - clocks and enables the controller, every channel starts disabled
+===================================================================================================
+*/
+void UDMA_Init(void){
+  SYSCTL_RCGCDMA_R |= SYSCTL_RCGCDMA_R0;
+  while ((SYSCTL_PRDMA_R & SYSCTL_PRDMA_R0) == 0) {};
+  
+  UDMA_CFG_R = UDMA_CFG_MASTEN;
+  UDMA_CTLBASE_R = (uint32_t)UDMA_Table;
+  UDMA_ENACLR_R = 0xFFFFFFFF;
+}
+
+/*
+===================================================================================================
+  UDMA :: UDMA_AssignChannel
+  
+   - routes a peripheral to a channel, 4 bit encodings packed 8 to a CHMAP register
+===================================================================================================
+*/
+void UDMA_AssignChannel(uint8_t channel, uint8_t encoding){
+  volatile uint32_t* map = &UDMA_CHMAP0_R + channel/8;
+  uint32_t shift = 4*(channel % 8);
+  *map = (*map & ~(0xFu << shift)) | ((uint32_t)encoding << shift);
+}
+
+/*
+===================================================================================================
+  UDMA :: UDMA_SetTransfer
+  
+   - fills in a control structure, the end pointers follow from the increment bits
+===================================================================================================
+*/
+void UDMA_SetTransfer(uint8_t channel, bool alternate, volatile void* source, volatile void* destination,
+                      uint32_t count, uint32_t control){
+  UDMA_Control* entry = &UDMA_Table[channel + (alternate ? UDMA_CHANNELS : 0)];
+  
+  // increments are 1 << field bytes, 3 means the address stays put
+  uint32_t srcInc = (control & UDMA_CHCTL_SRCINC_M) >> 26;
+  uint32_t dstInc = (control & UDMA_CHCTL_DSTINC_M) >> 30;
+  uint32_t last = count - 1;
+  
+  entry->srcEnd = (srcInc == 3) ? source : (volatile uint8_t*)source + (last << srcInc);
+  entry->dstEnd = (dstInc == 3) ? destination : (volatile uint8_t*)destination + (last << dstInc);
+  entry->control = (control & ~UDMA_CHCTL_XFERSIZE_M) | (last << 4);
+}
+
+/*
+===================================================================================================
+  UDMA :: UDMA_TransferDone
+  
+   - the controller sets a structure's mode back to stop when it has moved the last item
+===================================================================================================
+*/
+bool UDMA_TransferDone(uint8_t channel, bool alternate){
+  UDMA_Control* entry = &UDMA_Table[channel + (alternate ? UDMA_CHANNELS : 0)];
+  return (entry->control & UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP;
+}
+
+/*
+===================================================================================================
+  UDMA :: UDMA_EnableChannel / UDMA_DisableChannel
+  
+   - enable starts at the primary structure and takes single and burst requests
+===================================================================================================
+*/
+void UDMA_EnableChannel(uint8_t channel){
+  uint32_t bit = 1u << channel;
+  UDMA_ALTCLR_R = bit;
+  UDMA_USEBURSTCLR_R = bit;
+  UDMA_REQMASKCLR_R = bit;
+  UDMA_ENASET_R = bit;
+}
+void UDMA_DisableChannel(uint8_t channel){
+  UDMA_ENACLR_R = 1u << channel;
+}
@@ -0,0 +1,44 @@
+#ifndef UDMA_H
+#define UDMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Micro DMA controller: one channel control table for all 32 channels, primary structures
+// followed by the alternate ones used by ping-pong transfers.
+//
+// A peripheral channel's completion interrupt arrives on the peripheral's own vector, with the
+// channel's bit set in UDMA_CHIS_R (write 1 to clear).
+
+#define UDMA_CHANNELS  32
+#define UDMA_MAX_XFER  1024           // transfers per control structure
+
+// ADC0 sequencer 0 requests on channel 14, encoding 0
+#define UDMA_CH_ADC0_SS0 14
+
+// one channel control structure
+typedef struct {
+  volatile void* srcEnd;              // address of the last source item
+  volatile void* dstEnd;              // address of the last destination item
+  volatile uint32_t control;          // UDMA_CHCTL_* bits, transfer size and mode
+  uint32_t spare;
+} UDMA_Control;
+
+// enables the controller and points it at the control table
+void UDMA_Init(void);
+
+// selects which peripheral drives a channel (the CHMAP encoding, see the datasheet)
+void UDMA_AssignChannel(uint8_t channel, uint8_t encoding);
+
+// fills in a primary or alternate control structure, control holds the size, increment,
+// arbitration and mode bits and count (1 to UDMA_MAX_XFER) is added here
+void UDMA_SetTransfer(uint8_t channel, bool alternate, volatile void* source, volatile void* destination,
+                      uint32_t count, uint32_t control);
+
+// true once the hardware has finished the structure (its mode went back to stop)
+bool UDMA_TransferDone(uint8_t channel, bool alternate);
+
+void UDMA_EnableChannel(uint8_t channel);
+void UDMA_DisableChannel(uint8_t channel);
+
+#endif
@@ -1,5 +1,6 @@
 #include "tm4c123gh6pm.h"
 #include "usb_uart.h"
+#include "uart.h"
 
 #include "interpreter.h"
 #include "fifo.h"
@@ -16,17 +17,43 @@
 ========================================================================================================================
 */
 
-#define FIFOSIZE   64         // size of the FIFOs (must be power of 2)
 #define FIFOSUCCESS 1         // return value on success
 #define FIFOFAIL    0         // return value on failure
 
+#define LINE_COUNT  4         // number of line buffers in the pool (must be power of 2)
+#define FRAME_COUNT 4         // number of binary frame buffers in the pool (must be power of 2)
+
 /*
 ========================================================================================================================
 ==========                                          GLOBAL VARIABLES                                          ==========
 ========================================================================================================================
 */
 
-bool USB_BufferReady = false;
+volatile bool USB_BufferReady = false;
+
+// port the shell runs on
+UART_Port* USB_UART_Port = &UART_Ports[0];
+
+// pool of line buffers, filled by the RX interrupt and handed to the interpreter
+static char USB_LinePool[LINE_COUNT][USB_LINE_SIZE];
+
+// line currently being assembled by the RX interrupt (NULL if none claimed yet)
+static char* rxLine = NULL;
+static uint32_t rxLength = 0;
+
+// number of characters dropped because no line buffer was free
+uint32_t USB_DroppedChars = 0;
+
+// pool of binary frame buffers, a NUL byte switches the RX interrupt from text to frame mode
+static USB_Frame USB_FramePool[FRAME_COUNT];
+
+// frame currently being collected (NULL in frame mode means the frame is being discarded)
+static USB_Frame* rxFrame = NULL;
+static bool rxFrameMode = false;
+static bool rxDiscarding = false;                   // bytes of the current frame were thrown away
+
+// number of frames dropped because no frame buffer was free or the frame was too long
+uint32_t USB_DroppedFrames = 0;
 
 /*
 ========================================================================================================================
@@ -34,198 +61,251 @@ bool USB_BufferReady = false;
 ========================================================================================================================
 */
 
-// create index implementation FIFO (see FIFO.h)
-AddPointerFifo(Rx, FIFOSIZE, char, FIFOSUCCESS, FIFOFAIL)
-AddPointerFifo(Tx, FIFOSIZE, char, FIFOSUCCESS, FIFOFAIL)
+// free and completed line buffer pointers (see FIFO.h)
+typedef char* linePtr;
+AddIndexFifo(LineFree, LINE_COUNT, linePtr, FIFOSUCCESS, FIFOFAIL)
+AddIndexFifo(LineReady, LINE_COUNT, linePtr, FIFOSUCCESS, FIFOFAIL)
+
+// free and completed binary frame pointers (see FIFO.h)
+typedef USB_Frame* framePtr;
+AddIndexFifo(FrameFree, FRAME_COUNT, framePtr, FIFOSUCCESS, FIFOFAIL)
+AddIndexFifo(FrameReady, FRAME_COUNT, framePtr, FIFOSUCCESS, FIFOFAIL)
+
+static void USB_UART_HandleRXChar(UART_Port* port, char letter);
 
 /*
 ===================================================================================================
   USB_UART :: USB_UART_Init
   
-   - initializes the UART to use PA0,1 at 115200 baud
+   - opens the shell on UART0 (PA0,1) at 115200 baud and attaches the line discipline to it
 ===================================================================================================
 */
 void USB_UART_Init(void){
-  TxFifo_Init();
-  RxFifo_Init();
-  
-  // enable UART0
-  SYSCTL_RCGCUART_R |= SYSCTL_RCGCUART_R0; // activate UART0 clock gating
-  while ((SYSCTL_PRUART_R & SYSCTL_PRUART_R0) == 0) {}; // wait for UART0 to activate
-  
-  // enable PORTA
-  SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R0; // activate PORTA clock gating
-  while ((SYSCTL_PRGPIO_R & SYSCTL_PRGPIO_R0) == 0) {}; // wait for PORTA to activate
-  
-  // configure PORTA pins for use with UART0
-  GPIO_PORTA_AFSEL_R |= 0x03;
-  GPIO_PORTA_DEN_R   |= 0x03;
-  GPIO_PORTA_PCTL_R  |= 0x11;
-  GPIO_PORTA_DR2R_R  |= 0x03;
+  LineFreeFifo_Init();
+  LineReadyFifo_Init();
+  FrameFreeFifo_Init();
+  FrameReadyFifo_Init();
+
+  // every line and frame buffer starts out free
+  for (int i = 0; i < LINE_COUNT; i++){
+    LineFreeFifo_Put(USB_LinePool[i]);
+  }
+  for (int i = 0; i < FRAME_COUNT; i++){
+    FrameFreeFifo_Put(&USB_FramePool[i]);
+  }
+  rxLine = NULL;
+  rxLength = 0;
+  rxFrame = NULL;
+  rxFrameMode = false;
+  rxDiscarding = false;
   
-  // configure UART0 for 115200bps operation
-  // IBRD = 80e6/(16*115200) = 43.4027 = 43
-  // FBRD = integer(.402777*64 + 0.5)  = 26   
-  UART0_CTL_R &= ~0x01;                             // clear UART0 enable bit during config
-  UART0_IBRD_R = 43;                                // set integer portion of BRD
-  UART0_FBRD_R = 26;                                // set fraction portion of BRD
-  UART0_LCRH_R = (UART_LCRH_WLEN_8|UART_LCRH_FEN);  // 8 bit word length, 1 stop, no parity, FIFOs enabled
-  UART0_CC_R   = 0x00;                              // use system clock
-  UART0_IFLS_R &= ~0x3F;                            // clear TX and RX interrupt FIFO level fields
-  UART0_IFLS_R |= UART_IFLS_RX1_8;                  // RX FIFO interrupt threshold >= 1/8th full
-  UART0_IFLS_R |= UART_IFLS_TX1_8;                  // TX FIFO interrupt threshold <= 4/8th full
-  UART0_IM_R  |= (UART_IM_RXIM | UART_IM_RTIM);     // enable interupt on RX and RX transmission end
-  UART0_IM_R  |= UART_IM_TXIM;                      // enable interrupt on TX
-  UART0_CTL_R |= UART_CTL_UARTEN;                   // set UART0 enable bit    
+  UART_SetRxHandler(USB_UART_Port, USB_UART_HandleRXChar);
+  UART_Open(USB_UART_Port, 115200, UART_FLOW_NONE);
 }
 
-
-
 /*
 ===================================================================================================
-  USB_UART :: USB_UART_Enable_Interrupt
+  USB_UART :: USB_UART_PrintChar
   
-   - enables the UART0 interrupt
+   - queues a character for output on the shell port (see UART_PutChar)
 ===================================================================================================
 */
-void USB_UART_Enable_Interrupt(void){
-  NVIC_EN0_R |= NVIC_EN0_INT5;
+void USB_UART_PrintChar(char input){
+  UART_PutChar(USB_UART_Port, input);
 }
-
+	
 /*
 ===================================================================================================
-  USB_UART :: USB_UART_DisableRXInterrupt
-  
-   - disables the UART0 RX interrupt
+  USB_UART :: USB_UART_EchoChar
+		
+   - queues a character for output from interrupt context, dropping it if the TX ring is full
 ===================================================================================================
 */
-void USB_UART_DisableRXInterrupt(void){
-  NVIC_EN0_R &= ~NVIC_EN0_INT5;    
+static void USB_UART_EchoChar(char output){
+  UART_TryPutChar(USB_UART_Port, output);
 }
 
 /*
 ===================================================================================================
-  USB_UART :: UART0_Handler
-  
-   - handles incoming and outgoing UART0 interrupts
+  USB_UART :: USB_UART_CheckRXRoom
+		
+   - receive side flow control: pauses the host when we are down to the last free buffer, and
+     resumes it once half the buffers are free again (no-op without flow control)
 ===================================================================================================
 */
-
-int count_t=0;
-int count_b=0;
-int top=0;
-int bottom=0;
-int trigger_pt=0;
-volatile uint32_t RAW_INT_STAT;
-void UART0_Handler(void){
-	
-	
-	RAW_INT_STAT=UART0_RIS_R;
-	count_t++;
-	top++;
-	
-	// RX FIFO >= 1/8 full 
-  if(UART0_RIS_R & UART_RIS_RXRIS){       
-		RAW_INT_STAT=UART0_RIS_R;							//debug raw int status register
-    UART0_ICR_R = UART_ICR_RXIC;          // acknowledge interrupt
-    USB_UART_HandleRXBuffer();            // copy from hardware RX FIFO to software RX FIFO
+static void USB_UART_CheckRXRoom(void){
+  if (!USB_UART_Port->rxPaused && (LineFreeFifo_Size() <= 1 || FrameFreeFifo_Size() <= 1)){
+    UART_ThrottleRX(USB_UART_Port, true);
+  } else if (USB_UART_Port->rxPaused && LineFreeFifo_Size() >= LINE_COUNT/2 && FrameFreeFifo_Size() >= FRAME_COUNT/2){
+    UART_ThrottleRX(USB_UART_Port, false);
   }
-
-	// receiver TIME-OUT
-  if(UART0_RIS_R&UART_RIS_RTRIS){         
-    RAW_INT_STAT=UART0_RIS_R;
-		UART0_ICR_R = UART_ICR_RTIC;          // acknowledge receiver time
-    USB_UART_HandleRXBuffer();            // copy from hardware RX FIFO to software RX FIFO
-  }
- 
-	// hardware TX FIFO <= 2 items
-  if(UART0_RIS_R&UART_RIS_TXRIS){         
-		RAW_INT_STAT=UART0_RIS_R;
-    UART0_ICR_R = UART_ICR_TXIC;          // acknowledge TX FIFO
-		
-  }
-	
-	RAW_INT_STAT=UART0_RIS_R;
-	count_b++;
-	bottom++;
-	
-	
 }
 
-
-
 /*
 ===================================================================================================
-  USB_UART :: USB_UART_PrintChar
-  
-   - outputs a character via UART0
+  USB_UART :: USB_UART_HandleRXFrameByte
+
+   - collects one byte of a binary frame, the closing NUL posts the frame and returns to text mode
+   - back to back delimiters (empty frames) are ignored so the host may always lead with a NUL,
+     also while no buffer is free, so a discarded frame's bytes never reach the shell
 ===================================================================================================
 */
-void USB_UART_PrintChar(char input){
-	
-  while (UART0_FR_R & UART_FR_TXFF) {}//spin when fifo is full until fifo is not full}; FR flag register
-		
-	for(int i=0;i<4;i++){	
-		UART0_DR_R = input;
-		trigger_pt++;
-	}
+static void USB_UART_HandleRXFrameByte(char letter){
+  if (letter != 0){
+    if (rxFrame == NULL){
+      rxDiscarding = true;                          // frame is being discarded
+      return;
+    }
+    if (rxFrame->length >= USB_FRAME_SIZE){
+      FrameFreeFifo_Put(rxFrame);                   // too long, give the buffer back and discard
+      rxFrame = NULL;                               // counted as dropped at the closing delimiter
+      rxDiscarding = true;
+      return;
+    }
+    rxFrame->data[rxFrame->length++] = letter;
+    return;
+  }
+
+  // closing delimiter
+  if (rxFrame == NULL){
+    if (rxDiscarding){
+      USB_DroppedFrames++;
+      rxDiscarding = false;
+      rxFrameMode = false;
+    } else if (FrameFreeFifo_Get(&rxFrame) == FIFOSUCCESS){
+      rxFrame->length = 0;                          // empty frame, a buffer may have come free
+    }
+  } else if (rxFrame->length > 0){
+    FrameReadyFifo_Put(rxFrame);                    // can't fail, there are only FRAME_COUNT buffers
+    rxFrame = NULL;
+    rxFrameMode = false;
+    USB_BufferReady = true;
+    USB_UART_CheckRXRoom();
+  }
 }
 
 /*
 ===================================================================================================
-  USB_UART :: USB_UART_HandleRXBuffer
+  USB_UART :: USB_UART_HandleRXChar
   
-   - puts a character in the software FIFO, with a few special execptions
+   - line discipline, called by the port's RX interrupt with every good character
+   - assembles characters into a line buffer, CR terminates the line and posts it to the
+     interpreter, backspace removes a character
+   - echo goes through the software TX ring, never blocks
+   - a NUL byte (never typed in the text shell) starts a COBS binary frame, which is collected
+     without echo or editing until the closing NUL and posted whole to the frame handler
+   - with XON/XOFF enabled, XON/XOFF outside of a frame pause/resume our transmitter; XON/XOFF
+     is in band, so the host must not send it inside a frame
 ===================================================================================================
 */
-void USB_UART_HandleRXBuffer(void){
-  char letter;
-  while((UART0_FR_R & UART_FR_RXFE) == 0){					// if UART Receive FIFO is not Empty (1 means empty)
-    letter = UART0_DR_R; 
-
-		
-		/*
-		// take a character from the hardware fifo
-    if (letter =='\r') {   
-			
-      // new line, don't put in buffer
-      RxFifo_Put(0);                                // null terminate buffer
-      USB_BufferReady = true;                       // toggle buffer processing semaphore
-			
-    } else if (letter == '\n' || letter == 12) {    // ctrl-L is ASCII 12, form feed
-       // do nothing
-    } else if (letter == 8) {                       // handle backspace
-      RxFifo_Pop();                                 // remove a char from the end of the fifo
-      USB_UART_PrintChar(8);                        // return a backspace to the user
-      USB_UART_PrintChar(' ');                      // clear char on uart
+static void USB_UART_HandleRXChar(UART_Port* port, char letter){
+  if (rxFrameMode){
+    USB_UART_HandleRXFrameByte(letter);
+    return;
+  }
+  if (port->flow == UART_FLOW_XONXOFF && (letter == UART_XON || letter == UART_XOFF)){
+    UART_HoldTX(port, letter == UART_XOFF);
+    return;
+  }
+  if (letter == 0){
+    // start of a binary frame, any partially typed line is abandoned
+    rxLength = 0;
+    rxFrameMode = true;
+    rxDiscarding = false;
+    if (FrameFreeFifo_Get(&rxFrame) == FIFOFAIL){
+      rxFrame = NULL;                               // no buffer, swallow the frame
     } else {
-      RxFifo_Put(letter);                           // put char in fifo
+      rxFrame->length = 0;
     }
-		*/
+    return;
+  }
 		
-    USB_UART_PrintChar(letter);                     // echo typed character back to user terminal
-		USB_BufferReady = true;    
+  // claim a fresh line buffer if we don't have one
+  if (rxLine == NULL){
+    if (LineFreeFifo_Get(&rxLine) == FIFOFAIL){
+      rxLine = NULL;
+      USB_DroppedChars++;                           // interpreter is behind, nowhere to put it
+      port->errors.dropped++;
+      return;
+    }
+    rxLength = 0;
+  }
+			
+  if (letter == '\r') {
+    // end of line, null terminate and hand the whole line to the interpreter
+    rxLine[rxLength] = 0;
+    LineReadyFifo_Put(rxLine);                      // can't fail, there are only LINE_COUNT buffers
+    rxLine = NULL;
+    USB_BufferReady = true;                         // toggle buffer processing semaphore
+    USB_UART_EchoChar('\r');
+    USB_UART_EchoChar('\n');
+    USB_UART_CheckRXRoom();
+  } else if (letter == '\n' || letter == 12) {      // ctrl-L is ASCII 12, form feed
+     // do nothing
+  } else if (letter == 8 || letter == 127) {        // handle backspace (and DEL, which some terminals send)
+    if (rxLength > 0){
+      rxLength--;                                   // remove a char from the end of the line
+      USB_UART_EchoChar(8);                         // return a backspace to the user
+      USB_UART_EchoChar(' ');                       // clear char on uart
+      USB_UART_EchoChar(8);
+    }
+  } else if (rxLength < USB_LINE_SIZE - 1) {
+    rxLine[rxLength++] = letter;                    // put char in line
+    USB_UART_EchoChar(letter);                      // echo typed character back to user terminal
+  } else {
+    USB_DroppedChars++;                             // line full, leave room for the terminator
+    port->errors.dropped++;
+  }
+}
 		
+/*
+===================================================================================================
+  USB_UART :: USB_UART_GetLine
 		
+   - retrieves the next complete, null terminated line from the RX interrupt
+   - returns true if a line was available, the line must be given back with USB_UART_ReleaseLine
+===================================================================================================
+*/
+bool USB_UART_GetLine(char** line){
+  return (LineReadyFifo_Get(line) == FIFOSUCCESS);
+}
 		
+/*
+===================================================================================================
+  USB_UART :: USB_UART_ReleaseLine
 		
-  }
+   - returns a line buffer obtained from USB_UART_GetLine to the pool
+===================================================================================================
+*/
+void USB_UART_ReleaseLine(char* line){
+  long sr = StartCritical();              // RX interrupt also takes from the free FIFO
+  LineFreeFifo_Put(line);
+  USB_UART_CheckRXRoom();
+  EndCritical(sr);
 }
 
 /*
 ===================================================================================================
-  USB_UART :: USB_UART_HandleTXBuffer
-  
-   - does... something....
+  USB_UART :: USB_UART_GetFrame
+
+   - retrieves the next complete binary frame from the RX interrupt
+   - returns true if a frame was available, the frame must be given back with USB_UART_ReleaseFrame
 ===================================================================================================
 */
-void USB_UART_HandleTXBuffer(void){
-  char letter;
-  while(((UART0_FR_R&UART_FR_TXFF) == 0) && (TxFifo_Size() > 0)){ //while not full put copy from SW to HW fifo
-		
-    TxFifo_Get(&letter);
-    UART0_DR_R = letter;
-		
-  }
+bool USB_UART_GetFrame(USB_Frame** frame){
+  return (FrameReadyFifo_Get(frame) == FIFOSUCCESS);
 }
 
+/*
+===================================================================================================
+  USB_UART :: USB_UART_ReleaseFrame
+
+   - returns a frame buffer obtained from USB_UART_GetFrame to the pool
+===================================================================================================
+*/
+void USB_UART_ReleaseFrame(USB_Frame* frame){
+  long sr = StartCritical();              // RX interrupt also takes from the free FIFO
+  FrameFreeFifo_Put(frame);
+  USB_UART_CheckRXRoom();
+  EndCritical(sr);
+}
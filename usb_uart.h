@@ -1,20 +1,33 @@
 #ifndef USB_UART_H
 #define USB_UART_H
 
-#define FIFO_SIZE 64
+#define USB_LINE_SIZE 64      // max characters per line, including null terminator
+#define USB_FRAME_SIZE 264    // max COBS encoded bytes per binary frame, excluding delimiters
 
 #include "stdint.h"
 #include "stdbool.h"
 
-extern bool USB_BufferReady;
+#include "uart.h"
+
+// The shell link: line discipline and binary frame collection attached to a UART port as its
+// RX handler (UART0 at 115200 by default), feeding the interpreter and the frame handler.
+
+// raw (still COBS encoded) binary frame collected by the RX interrupt
+typedef struct {
+  uint16_t length;                    // number of encoded bytes in data
+  uint8_t data[USB_FRAME_SIZE];
+} USB_Frame;
+
+extern volatile bool USB_BufferReady;
+extern uint32_t USB_DroppedChars;
+extern uint32_t USB_DroppedFrames;
+extern UART_Port* USB_UART_Port;
 
 void USB_UART_Init(void);
 void USB_UART_PrintChar(char iput);
-void USB_UART_Enable_Interrupt(void);
-void USB_UART_DisableRXInterrupt(void);
-void USB_UART_HandleRXBuffer(void);
-void USB_UART_HandleTXBuffer(void);
-
-void UART0_Handler(void);
+bool USB_UART_GetLine(char** line);
+void USB_UART_ReleaseLine(char* line);
+bool USB_UART_GetFrame(USB_Frame** frame);
+void USB_UART_ReleaseFrame(USB_Frame* frame);
 
 #endif